@@ -0,0 +1,255 @@
+#include "adfgvx_batch.h"
+#include "adfgvx_core.h" // Para adfgvx_key_order
+#include "adfgvx_grid.h" // Matriz e simbolos da cifra (adfgvx_grid_*)
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Na tabela adfgvx_grid_cell_table, 0 marca caractere fora da matriz e os demais
+// valores sao o indice da celula + 1.
+#define INVALID_CELL 0
+
+long adfgvx_batch_arena_size(const char *const messages[], int message_count)
+{
+    long total = 0;
+
+    for (int i = 0; i < message_count; i++)
+    {
+        if (messages[i] != NULL)
+            total += 2 * (long)strlen(messages[i]);
+    }
+    return total;
+}
+
+/**
+ * @brief Substitui um bloco [posicao][lane] pelos simbolos de linha e de coluna da matriz.
+ * Lanes inativas (celula INVALID_CELL) recebem 0 nos dois simbolos. Nao ha desvio por lane:
+ * com SSE2, cada posicao processa 16 lanes por vez, com a mascara de lanes ativas calculada
+ * por comparacao; sem SSE2, as lanes sao resolvidas por consulta a tabela.
+ * (Funcao auxiliar estatica)
+ */
+static void substitute_block(const unsigned char block[][ADFGVX_BATCH_LANES], long block_len,
+                             unsigned char row_symbols[][ADFGVX_BATCH_LANES],
+                             unsigned char col_symbols[][ADFGVX_BATCH_LANES])
+{
+#if defined(__SSE2__) && ADFGVX_BATCH_LANES % 16 == 0
+    // Celulas de 1 a ADFGVX_GRID_SIZE^2 (no maximo 64) cabem em bytes com sinal.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i grid_size = _mm_set1_epi8(ADFGVX_GRID_SIZE);
+    __m128i row_limit[ADFGVX_GRID_SIZE];
+    __m128i index_vec[ADFGVX_GRID_SIZE];
+    __m128i symbol_vec[ADFGVX_GRID_SIZE];
+    for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+    {
+        row_limit[s] = _mm_set1_epi8((char)(s * ADFGVX_GRID_SIZE - 1));
+        index_vec[s] = _mm_set1_epi8((char)s);
+        symbol_vec[s] = _mm_set1_epi8(adfgvx_grid_symbols[s]);
+    }
+
+    for (long p = 0; p < block_len; p++)
+    {
+        for (int l = 0; l < ADFGVX_BATCH_LANES; l += 16)
+        {
+            __m128i code = _mm_loadu_si128((const __m128i *)&block[p][l]);
+            __m128i active = _mm_cmpgt_epi8(code, zero);
+            __m128i cell = _mm_sub_epi8(code, one);
+
+            // linha = numero de limites s * ADFGVX_GRID_SIZE ultrapassados; coluna = o resto.
+            __m128i row = zero;
+            __m128i col = cell;
+            for (int s = 1; s < ADFGVX_GRID_SIZE; s++)
+            {
+                __m128i above = _mm_cmpgt_epi8(cell, row_limit[s]);
+                row = _mm_sub_epi8(row, above);
+                col = _mm_sub_epi8(col, _mm_and_si128(above, grid_size));
+            }
+
+            __m128i row_symbol = zero;
+            __m128i col_symbol = zero;
+            for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+            {
+                row_symbol = _mm_or_si128(row_symbol, _mm_and_si128(_mm_cmpeq_epi8(row, index_vec[s]), symbol_vec[s]));
+                col_symbol = _mm_or_si128(col_symbol, _mm_and_si128(_mm_cmpeq_epi8(col, index_vec[s]), symbol_vec[s]));
+            }
+
+            _mm_storeu_si128((__m128i *)&row_symbols[p][l], _mm_and_si128(row_symbol, active));
+            _mm_storeu_si128((__m128i *)&col_symbols[p][l], _mm_and_si128(col_symbol, active));
+        }
+    }
+#else
+    // Indices por codigo de celula (0 = INVALID_CELL, que vira o simbolo 0).
+    unsigned char row_table[ADFGVX_GRID_SIZE * ADFGVX_GRID_SIZE + 1] = {0};
+    unsigned char col_table[ADFGVX_GRID_SIZE * ADFGVX_GRID_SIZE + 1] = {0};
+    for (int cell = 0; cell < ADFGVX_GRID_SIZE * ADFGVX_GRID_SIZE; cell++)
+    {
+        row_table[cell + 1] = (unsigned char)adfgvx_grid_symbols[cell / ADFGVX_GRID_SIZE];
+        col_table[cell + 1] = (unsigned char)adfgvx_grid_symbols[cell % ADFGVX_GRID_SIZE];
+    }
+
+    for (long p = 0; p < block_len; p++)
+    {
+        for (int l = 0; l < ADFGVX_BATCH_LANES; l++)
+        {
+            row_symbols[p][l] = row_table[block[p][l]];
+            col_symbols[p][l] = col_table[block[p][l]];
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Cifra um grupo de ate ADFGVX_BATCH_LANES mensagens.
+ * (Funcao auxiliar estatica)
+ *
+ * @param base Posicao na arena onde comeca o texto cifrado da primeira mensagem do grupo.
+ * @return long Posicao na arena logo apos o texto cifrado da ultima mensagem do grupo.
+ */
+static long cipher_group(const int order[],
+                         int key_length,
+                         const char *const messages[],
+                         int lanes,
+                         char *arena,
+                         long base,
+                         long offsets[])
+{
+    // Estado por lane em estrutura de arrays. Lanes alem de `lanes` ficam vazias.
+    long length[ADFGVX_BATCH_LANES] = {0};
+    long lane_base[ADFGVX_BATCH_LANES];
+    long row[ADFGVX_BATCH_LANES];
+    int column[ADFGVX_BATCH_LANES];
+    long column_start[ADFGVX_BATCH_LANES][MAX_KEY_LENGTH];
+    long max_length = 0;
+
+    // Bloco de caracteres transpostos, block[posicao][lane], e os simbolos de cada posicao.
+    unsigned char block[ADFGVX_BATCH_BLOCK][ADFGVX_BATCH_LANES];
+    unsigned char row_symbols[ADFGVX_BATCH_BLOCK][ADFGVX_BATCH_LANES];
+    unsigned char col_symbols[ADFGVX_BATCH_BLOCK][ADFGVX_BATCH_LANES];
+
+    // 1) Conta os simbolos validos de cada mensagem e posiciona as colunas na arena.
+    for (int l = 0; l < lanes; l++)
+    {
+        const char *msg = messages[l] != NULL ? messages[l] : "";
+        long valid = 0;
+
+        length[l] = (long)strlen(msg);
+        for (long p = 0; p < length[l]; p++)
+            valid += adfgvx_grid_cell_table[(unsigned char)msg[p]] != INVALID_CELL;
+        if (length[l] > max_length)
+            max_length = length[l];
+
+        long symbol_count = 2 * valid;
+        long rows = symbol_count / key_length;
+        long extra = symbol_count % key_length;
+        long pos = 0;
+
+        // A coluna original c tem rows + (c < extra) simbolos; no texto cifrado as
+        // colunas aparecem na ordem alfabetica da chave.
+        for (int i = 0; i < key_length; i++)
+        {
+            int c = order[i];
+            column_start[l][c] = pos;
+            pos += rows + (c < extra ? 1 : 0);
+        }
+
+        offsets[l] = base;
+        lane_base[l] = base;
+        row[l] = 0;
+        column[l] = 0;
+        base += symbol_count;
+    }
+
+    for (long block_start = 0; block_start < max_length; block_start += ADFGVX_BATCH_BLOCK)
+    {
+        long block_len = max_length - block_start;
+        if (block_len > ADFGVX_BATCH_BLOCK)
+            block_len = ADFGVX_BATCH_BLOCK;
+
+        // 2) Transpoe os caracteres para [posicao][lane]. Mascara para comprimentos diferentes:
+        // posicoes alem do fim (e lanes vazias) viram celulas invalidas.
+        for (int l = 0; l < ADFGVX_BATCH_LANES; l++)
+        {
+            const char *msg = l < lanes && messages[l] != NULL ? messages[l] : "";
+            for (long p = 0; p < block_len; p++)
+            {
+                long src = block_start + p;
+                block[p][l] = src < length[l] ? adfgvx_grid_cell_table[(unsigned char)msg[src]] : INVALID_CELL;
+            }
+        }
+
+        // 3) Substituicao de todas as lanes em paralelo, sem desvios.
+        substitute_block((const unsigned char (*)[ADFGVX_BATCH_LANES])block, block_len, row_symbols, col_symbols);
+
+        // 4) Transposicao: espalha os pares de cada lane nas suas posicoes finais da arena.
+        // O destino depende de quantos simbolos a lane ja emitiu, por isso cada lane e
+        // percorrida em sequencia, com linha e coluna em variaveis locais.
+        for (int l = 0; l < lanes; l++)
+        {
+            char *lane_arena = arena + lane_base[l];
+            const long *start = column_start[l];
+            long lane_row = row[l];
+            int lane_column = column[l];
+
+            for (long p = 0; p < block_len; p++)
+            {
+                if (row_symbols[p][l] == 0)
+                    continue;
+
+                lane_arena[start[lane_column] + lane_row] = (char)row_symbols[p][l];
+                if (++lane_column == key_length)
+                {
+                    lane_column = 0;
+                    lane_row++;
+                }
+                lane_arena[start[lane_column] + lane_row] = (char)col_symbols[p][l];
+                if (++lane_column == key_length)
+                {
+                    lane_column = 0;
+                    lane_row++;
+                }
+            }
+
+            row[l] = lane_row;
+            column[l] = lane_column;
+        }
+    }
+
+    return base;
+}
+
+int cipher_adfgvx_batch(const char *key,
+                        int key_length,
+                        const char *const messages[],
+                        int message_count,
+                        char *arena,
+                        long arena_capacity,
+                        long offsets[])
+{
+    int order[MAX_KEY_LENGTH];
+    long base = 0;
+
+    if (key == NULL || key_length <= 0 || key_length >= MAX_KEY_LENGTH ||
+        messages == NULL || message_count < 0 || offsets == NULL)
+    {
+        return 2;
+    }
+    if (arena == NULL || adfgvx_batch_arena_size(messages, message_count) > arena_capacity)
+    {
+        return 1;
+    }
+
+    adfgvx_key_order(key, key_length, order);
+
+    for (int first = 0; first < message_count; first += ADFGVX_BATCH_LANES)
+    {
+        int lanes = message_count - first;
+        if (lanes > ADFGVX_BATCH_LANES)
+            lanes = ADFGVX_BATCH_LANES;
+
+        base = cipher_group(order, key_length, messages + first, lanes, arena, base, offsets + first);
+    }
+    offsets[message_count] = base;
+    return 0;
+}
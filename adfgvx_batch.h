@@ -0,0 +1,53 @@
+#ifndef ADFGVX_BATCH_H
+#define ADFGVX_BATCH_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH
+
+// Numero de mensagens cifradas simultaneamente (uma por "lane").
+#define ADFGVX_BATCH_LANES 16
+
+// Numero de posicoes de caracteres transpostas por vez para o layout SoA (estrutura de arrays).
+#define ADFGVX_BATCH_BLOCK 64
+
+/**
+ * @brief Calcula o tamanho de arena necessario para cifrar um lote de mensagens.
+ * Cada caractere gera no maximo dois simbolos ADFGVX.
+ *
+ * @param messages Vetor de mensagens (strings terminadas em nulo).
+ * @param message_count Numero de mensagens em messages.
+ * @return long Numero de bytes necessarios em `arena` para cipher_adfgvx_batch().
+ */
+long adfgvx_batch_arena_size(const char *const messages[], int message_count);
+
+/**
+ * @brief Cifra varias mensagens curtas com a mesma chave em uma unica chamada.
+ *
+ * As mensagens sao processadas em grupos de ADFGVX_BATCH_LANES. Em cada grupo, os
+ * caracteres sao transpostos para um bloco [posicao][lane], e a substituicao percorre as
+ * lanes sem desvios: com SSE2, 16 lanes por instrucao, com uma mascara de lanes ativas para
+ * comprimentos diferentes e caracteres fora da matriz. Em uma segunda passada, os pares de
+ * cada lane sao espalhados em forma fechada: cada simbolo e escrito diretamente na sua
+ * posicao final, sem matriz intermediaria nem troca de colunas.
+ *
+ * O resultado e identico a cipher_adfgvx() seguido da leitura coluna a coluna
+ * (como em write_encrypted_data_to_file()); caracteres fora da matriz sao ignorados.
+ *
+ * @param key A chave usada na transposicao.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @param messages Vetor de mensagens (strings terminadas em nulo).
+ * @param message_count Numero de mensagens.
+ * @param arena Buffer contiguo de saida. Os textos cifrados NAO sao terminados em nulo.
+ * @param arena_capacity Tamanho de arena (ver adfgvx_batch_arena_size()).
+ * @param offsets Vetor com message_count + 1 posicoes. O texto cifrado da mensagem i
+ * ocupa arena[offsets[i]] ate arena[offsets[i + 1] - 1].
+ * @return int 0 em caso de sucesso, 1 se a arena for pequena demais, 2 se parametros invalidos.
+ */
+int cipher_adfgvx_batch(const char *key,
+                        int key_length,
+                        const char *const messages[],
+                        int message_count,
+                        char *arena,
+                        long arena_capacity,
+                        long offsets[]);
+
+#endif // ADFGVX_BATCH_H
@@ -0,0 +1,336 @@
+#define _POSIX_C_SOURCE 200809L // Para pthread_rwlock_t
+#include "adfgvx_cache.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tipos de resultado guardados no cache (fazem parte da identidade da entrada).
+#define CACHE_KIND_CIPHER 0
+#define CACHE_KIND_DECIPHER 1
+
+/**
+ * @brief Uma entrada do cache: a entrada original e o resultado, guardados logo apos a estrutura.
+ */
+typedef struct cache_entry
+{
+    struct cache_entry *bucket_next; // Proxima entrada na mesma lista da tabela hash.
+    struct cache_entry *lru_prev;    // Entrada usada mais recentemente que esta.
+    struct cache_entry *lru_next;    // Entrada usada ha mais tempo que esta.
+    uint64_t hash;
+    int kind;
+    int key_length;
+    long input_length;
+    long output_length;
+    long bytes;                      // Memoria contabilizada para esta entrada.
+    char key[MAX_KEY_LENGTH];
+    char data[];                     // Entrada + '\0' seguida do resultado + '\0'.
+} cache_entry;
+
+struct adfgvx_cache
+{
+    pthread_rwlock_t table_lock; // Leitura: buscas. Escrita: insercoes e descartes.
+    pthread_mutex_t lru_lock;    // Protege a lista LRU e os contadores durante as buscas.
+    cache_entry *buckets[ADFGVX_CACHE_BUCKETS];
+    cache_entry *lru_head;       // Usada mais recentemente.
+    cache_entry *lru_tail;       // Proxima a ser descartada.
+    long max_bytes;
+    long bytes;
+    long entries;
+    long hits;
+    long misses;
+    long evictions;
+};
+
+/**
+ * @brief Hash FNV-1a de 64 bits de (tipo, chave, entrada).
+ * (Funcao auxiliar estatica)
+ */
+static uint64_t cache_hash(int kind, const char *key, int key_length, const char *input, long input_length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    hash = (hash ^ (unsigned char)kind) * 1099511628211ULL;
+    hash = (hash ^ (unsigned char)key_length) * 1099511628211ULL;
+    for (int i = 0; i < key_length; i++)
+        hash = (hash ^ (unsigned char)key[i]) * 1099511628211ULL;
+    for (long i = 0; i < input_length; i++)
+        hash = (hash ^ (unsigned char)input[i]) * 1099511628211ULL;
+    return hash;
+}
+
+/**
+ * @brief Procura a entrada de (tipo, chave, entrada). Exige table_lock (leitura ou escrita).
+ * O hash so escolhe a lista; a entrada e sempre comparada por inteiro.
+ * (Funcao auxiliar estatica)
+ */
+static cache_entry *cache_find(const adfgvx_cache *cache, uint64_t hash, int kind, const char *key, int key_length,
+                               const char *input, long input_length)
+{
+    cache_entry *entry = cache->buckets[hash & (ADFGVX_CACHE_BUCKETS - 1)];
+
+    for (; entry != NULL; entry = entry->bucket_next)
+    {
+        if (entry->hash == hash && entry->kind == kind && entry->key_length == key_length &&
+            entry->input_length == input_length && memcmp(entry->key, key, key_length) == 0 &&
+            memcmp(entry->data, input, input_length) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Retira uma entrada da lista LRU. Exige table_lock para escrita ou lru_lock.
+ * (Funcao auxiliar estatica)
+ */
+static void lru_unlink(adfgvx_cache *cache, cache_entry *entry)
+{
+    if (entry->lru_prev != NULL)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+    if (entry->lru_next != NULL)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+}
+
+/**
+ * @brief Coloca uma entrada no inicio da lista LRU (usada mais recentemente).
+ * (Funcao auxiliar estatica)
+ */
+static void lru_push_front(adfgvx_cache *cache, cache_entry *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != NULL)
+        cache->lru_head->lru_prev = entry;
+    cache->lru_head = entry;
+    if (cache->lru_tail == NULL)
+        cache->lru_tail = entry;
+}
+
+/**
+ * @brief Descarta a entrada usada ha mais tempo. Exige table_lock para escrita.
+ * (Funcao auxiliar estatica)
+ */
+static void cache_evict_oldest(adfgvx_cache *cache)
+{
+    cache_entry *victim = cache->lru_tail;
+    cache_entry **link = &cache->buckets[victim->hash & (ADFGVX_CACHE_BUCKETS - 1)];
+
+    while (*link != victim)
+        link = &(*link)->bucket_next;
+    *link = victim->bucket_next;
+    lru_unlink(cache, victim);
+
+    cache->bytes -= victim->bytes;
+    cache->entries--;
+    cache->evictions++;
+    free(victim);
+}
+
+/**
+ * @brief Busca um resultado e, se encontrado, copia-o para output (se couber) e o marca como recente.
+ * (Funcao auxiliar estatica)
+ *
+ * @return long Comprimento do resultado guardado, ou -1 se nao estiver no cache.
+ */
+static long cache_lookup(adfgvx_cache *cache, uint64_t hash, int kind, const char *key, int key_length,
+                         const char *input, long input_length, char *output, long output_size)
+{
+    long found = -1;
+
+    pthread_rwlock_rdlock(&cache->table_lock);
+    cache_entry *entry = cache_find(cache, hash, kind, key, key_length, input, input_length);
+    if (entry != NULL)
+    {
+        found = entry->output_length;
+        if (found < output_size)
+            memcpy(output, entry->data + input_length + 1, found + 1);
+    }
+
+    pthread_mutex_lock(&cache->lru_lock);
+    if (entry != NULL)
+    {
+        lru_unlink(cache, entry);
+        lru_push_front(cache, entry);
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&cache->lru_lock);
+    pthread_rwlock_unlock(&cache->table_lock);
+
+    return found;
+}
+
+/**
+ * @brief Guarda um resultado, descartando entradas antigas ate caber no limite de memoria.
+ * Se outra thread ja guardou o mesmo resultado, ou se ele sozinho passar do limite, nada e feito.
+ * (Funcao auxiliar estatica)
+ */
+static void cache_insert(adfgvx_cache *cache, uint64_t hash, int kind, const char *key, int key_length,
+                         const char *input, long input_length, const char *output, long output_length)
+{
+    long bytes = (long)sizeof(cache_entry) + input_length + output_length + 2;
+    if (bytes > cache->max_bytes)
+        return;
+
+    // Aloca e preenche fora do bloqueio exclusivo.
+    cache_entry *entry = malloc((size_t)bytes);
+    if (entry == NULL)
+        return;
+    entry->hash = hash;
+    entry->kind = kind;
+    entry->key_length = key_length;
+    entry->input_length = input_length;
+    entry->output_length = output_length;
+    entry->bytes = bytes;
+    memcpy(entry->key, key, key_length);
+    memcpy(entry->data, input, input_length);
+    entry->data[input_length] = '\0';
+    memcpy(entry->data + input_length + 1, output, output_length);
+    entry->data[input_length + 1 + output_length] = '\0';
+
+    pthread_rwlock_wrlock(&cache->table_lock);
+    if (cache_find(cache, hash, kind, key, key_length, input, input_length) != NULL)
+    {
+        pthread_rwlock_unlock(&cache->table_lock);
+        free(entry);
+        return;
+    }
+
+    while (cache->bytes + bytes > cache->max_bytes)
+        cache_evict_oldest(cache);
+
+    cache_entry **bucket = &cache->buckets[hash & (ADFGVX_CACHE_BUCKETS - 1)];
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+    lru_push_front(cache, entry);
+    cache->bytes += bytes;
+    cache->entries++;
+    pthread_rwlock_unlock(&cache->table_lock);
+}
+
+adfgvx_cache *adfgvx_cache_create(long max_bytes)
+{
+    if (max_bytes <= 0)
+        return NULL;
+
+    adfgvx_cache *cache = calloc(1, sizeof(*cache));
+    if (cache == NULL)
+        return NULL;
+
+    if (pthread_rwlock_init(&cache->table_lock, NULL) != 0)
+    {
+        free(cache);
+        return NULL;
+    }
+    if (pthread_mutex_init(&cache->lru_lock, NULL) != 0)
+    {
+        pthread_rwlock_destroy(&cache->table_lock);
+        free(cache);
+        return NULL;
+    }
+    cache->max_bytes = max_bytes;
+    return cache;
+}
+
+void adfgvx_cache_destroy(adfgvx_cache *cache)
+{
+    if (cache == NULL)
+        return;
+
+    cache_entry *entry = cache->lru_head;
+    while (entry != NULL)
+    {
+        cache_entry *next = entry->lru_next;
+        free(entry);
+        entry = next;
+    }
+    pthread_rwlock_destroy(&cache->table_lock);
+    pthread_mutex_destroy(&cache->lru_lock);
+    free(cache);
+}
+
+int cipher_adfgvx_cached(adfgvx_cache *cache, const adfgvx_profile *profile, const char *key, int key_length,
+                         const char *message, char *output, int output_size)
+{
+    if (cache == NULL || key == NULL || message == NULL || output == NULL || output_size <= 0 ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        return cipher_adfgvx_auto(profile, key, key_length, message, output, output_size);
+    }
+
+    long message_length = (long)strlen(message);
+    uint64_t hash = cache_hash(CACHE_KIND_CIPHER, key, key_length, message, message_length);
+
+    long found = cache_lookup(cache, hash, CACHE_KIND_CIPHER, key, key_length, message, message_length,
+                              output, output_size);
+    if (found >= 0)
+    {
+        if (found >= output_size)
+        {
+            output[0] = '\0';
+            return 1;
+        }
+        return 0;
+    }
+
+    int status = cipher_adfgvx_auto(profile, key, key_length, message, output, output_size);
+    if (status == 0)
+        cache_insert(cache, hash, CACHE_KIND_CIPHER, key, key_length, message, message_length,
+                     output, (long)strlen(output));
+    return status;
+}
+
+void decipher_adfgvx_cached(adfgvx_cache *cache, const adfgvx_profile *profile, const char *encrypted_text,
+                            const char *key, int key_length, char *output)
+{
+    if (cache == NULL || key == NULL || encrypted_text == NULL || output == NULL ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        decipher_adfgvx_auto(profile, encrypted_text, key, key_length, output);
+        return;
+    }
+
+    long text_length = (long)strlen(encrypted_text);
+    uint64_t hash = cache_hash(CACHE_KIND_DECIPHER, key, key_length, encrypted_text, text_length);
+
+    // Todo resultado guardado cabe em MAX_MESSAGE_LENGTH posicoes, como o de decipher_adfgvx().
+    if (cache_lookup(cache, hash, CACHE_KIND_DECIPHER, key, key_length, encrypted_text, text_length,
+                     output, MAX_MESSAGE_LENGTH) >= 0)
+    {
+        return;
+    }
+
+    decipher_adfgvx_auto(profile, encrypted_text, key, key_length, output);
+    cache_insert(cache, hash, CACHE_KIND_DECIPHER, key, key_length, encrypted_text, text_length,
+                 output, (long)strlen(output));
+}
+
+void adfgvx_cache_get_stats(adfgvx_cache *cache, adfgvx_cache_stats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (cache == NULL)
+        return;
+
+    pthread_rwlock_rdlock(&cache->table_lock);
+    pthread_mutex_lock(&cache->lru_lock);
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->entries = cache->entries;
+    stats->bytes = cache->bytes;
+    stats->max_bytes = cache->max_bytes;
+    pthread_mutex_unlock(&cache->lru_lock);
+    pthread_rwlock_unlock(&cache->table_lock);
+}
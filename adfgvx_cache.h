@@ -0,0 +1,75 @@
+#ifndef ADFGVX_CACHE_H
+#define ADFGVX_CACHE_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH, MAX_MESSAGE_LENGTH
+#include "adfgvx_dispatch.h" // Para adfgvx_profile
+
+// Numero de listas da tabela hash do cache (potencia de 2).
+#define ADFGVX_CACHE_BUCKETS 4096
+
+/**
+ * @brief Cache de resultados de cifragem e decifragem, indexado por (chave, hash da entrada).
+ *
+ * O consumo de memoria (entradas + textos guardados) fica limitado a max_bytes; ao inserir
+ * alem do limite, as entradas usadas ha mais tempo (LRU) sao descartadas. Varias threads
+ * podem consultar o mesmo cache ao mesmo tempo: as buscas compartilham um bloqueio de
+ * leitura e so as insercoes o obtem com exclusividade.
+ *
+ * A estrutura e opaca; use adfgvx_cache_create() e adfgvx_cache_destroy().
+ */
+typedef struct adfgvx_cache adfgvx_cache;
+
+/**
+ * @brief Contadores do cache (ver adfgvx_cache_get_stats()).
+ */
+typedef struct adfgvx_cache_stats
+{
+    long hits;       // Consultas respondidas pelo cache.
+    long misses;     // Consultas que precisaram calcular o resultado.
+    long evictions;  // Entradas descartadas para respeitar o limite de memoria.
+    long entries;    // Entradas guardadas no momento.
+    long bytes;      // Memoria ocupada pelas entradas no momento.
+    long max_bytes;  // Limite de memoria configurado.
+} adfgvx_cache_stats;
+
+/**
+ * @brief Cria um cache vazio.
+ *
+ * @param max_bytes Limite de memoria para as entradas (resultados maiores que o limite nao sao guardados).
+ * @return adfgvx_cache* O cache, ou NULL se max_bytes for invalido ou faltar memoria.
+ */
+adfgvx_cache *adfgvx_cache_create(long max_bytes);
+
+/**
+ * @brief Libera o cache e todas as suas entradas. Nenhuma thread pode estar usando o cache.
+ */
+void adfgvx_cache_destroy(adfgvx_cache *cache);
+
+/**
+ * @brief Cifra uma mensagem, reaproveitando o resultado se (chave, mensagem) ja estiver no cache.
+ * Em caso de falta, cifra com cipher_adfgvx_auto() e guarda o resultado.
+ * Mesmos parametros e retorno de cipher_adfgvx_auto().
+ *
+ * @param cache Cache a ser usado (se NULL, apenas cifra).
+ * @param profile Perfil do despachante (pode ser NULL, ver cipher_adfgvx_auto()).
+ */
+int cipher_adfgvx_cached(adfgvx_cache *cache, const adfgvx_profile *profile, const char *key, int key_length,
+                         const char *message, char *output, int output_size);
+
+/**
+ * @brief Decifra um texto, reaproveitando o resultado se (chave, texto cifrado) ja estiver no cache.
+ * Em caso de falta, decifra com decipher_adfgvx_auto() e guarda o resultado.
+ * Mesmo contrato de decipher_adfgvx(): output deve ter MAX_MESSAGE_LENGTH posicoes.
+ *
+ * @param cache Cache a ser usado (se NULL, apenas decifra).
+ * @param profile Perfil do despachante (pode ser NULL, ver decipher_adfgvx_auto()).
+ */
+void decipher_adfgvx_cached(adfgvx_cache *cache, const adfgvx_profile *profile, const char *encrypted_text,
+                            const char *key, int key_length, char *output);
+
+/**
+ * @brief Le os contadores do cache.
+ */
+void adfgvx_cache_get_stats(adfgvx_cache *cache, adfgvx_cache_stats *stats);
+
+#endif // ADFGVX_CACHE_H
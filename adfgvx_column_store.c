@@ -0,0 +1,359 @@
+#include "adfgvx_column_store.h"
+#include "adfgvx_core.h" // Para adfgvx_key_order
+#include "adfgvx_grid.h" // Matriz e simbolos da cifra (adfgvx_grid_*)
+#include "file_operations.h" // Para file_seek_64, file_sync, file_replace
+#include <inttypes.h> // Para PRId64 e SCNd64
+#include <string.h>
+
+// Numero de caracteres de texto cifrados por vez durante um acrescimo.
+#define APPEND_CHUNK 512
+
+// Tamanho do buffer de copia usado ao linearizar as colunas.
+#define COPY_BUFFER 4096
+
+/**
+ * @brief Numero de simbolos da coluna original `col` quando o total e `symbol_count`.
+ * (Funcao auxiliar estatica)
+ */
+static int64_t column_length(int64_t symbol_count, int key_length, int col)
+{
+    return symbol_count / key_length + (col < symbol_count % key_length ? 1 : 0);
+}
+
+/**
+ * @brief Monta o caminho de um arquivo do armazenamento ("<prefixo><sufixo>").
+ * (Funcao auxiliar estatica)
+ */
+static void store_path(const adfgvx_column_store *store, const char *suffix, int col, char *path)
+{
+    if (col >= 0)
+        snprintf(path, ADFGVX_STORE_PATH_MAX + 16, "%s%s%d", store->path_prefix, suffix, col);
+    else
+        snprintf(path, ADFGVX_STORE_PATH_MAX + 16, "%s%s", store->path_prefix, suffix);
+}
+
+/**
+ * @brief Grava o manifesto com o comprimento da chave e o total de simbolos.
+ * O novo conteudo vai para "<prefixo>.manifest.tmp", que e sincronizado e renomeado sobre
+ * o manifesto: uma interrupcao nunca deixa o manifesto vazio ou pela metade.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir ou escrever no arquivo.
+ */
+static int write_manifest(const adfgvx_column_store *store)
+{
+    char path[ADFGVX_STORE_PATH_MAX + 16];
+    char temp_path[ADFGVX_STORE_PATH_MAX + 16];
+    store_path(store, ".manifest", -1, path);
+    store_path(store, ".manifest.tmp", -1, temp_path);
+
+    FILE *manifest = fopen(temp_path, "w");
+    if (manifest == NULL)
+    {
+        perror("Erro ao abrir o manifesto do armazenamento para escrita");
+        return 1;
+    }
+    fprintf(manifest, "ADFGVX-COLUMN-STORE 1\nkey_length %d\nsymbols %" PRId64 "\n", store->key_length, store->symbol_count);
+    int status = file_sync(manifest);
+    if (fclose(manifest) != 0 || status != 0 || file_replace(temp_path, path) != 0)
+    {
+        perror("Erro ao escrever o manifesto do armazenamento");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Abre os segmentos de todas as colunas.
+ * (Funcao auxiliar estatica)
+ *
+ * @param mode Modo de fopen ("w+b" para criar, "r+b" para abrir).
+ * @return int 0 em caso de sucesso, 1 se algum segmento nao puder ser aberto.
+ */
+static int open_segments(adfgvx_column_store *store, const char *mode)
+{
+    char path[ADFGVX_STORE_PATH_MAX + 16];
+
+    for (int i = 0; i < store->key_length; i++)
+    {
+        store_path(store, ".col", i, path);
+        store->segment[i] = fopen(path, mode);
+        if (store->segment[i] == NULL)
+        {
+            adfgvx_store_close(store);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Valida e copia o prefixo de caminho, zerando o restante do estado.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 2 se parametros invalidos.
+ */
+static int init_store(adfgvx_column_store *store, const char *path_prefix)
+{
+    if (store == NULL)
+        return 2;
+    memset(store, 0, sizeof(*store));
+
+    if (path_prefix == NULL || strlen(path_prefix) >= ADFGVX_STORE_PATH_MAX)
+        return 2;
+    strcpy(store->path_prefix, path_prefix);
+    return 0;
+}
+
+int adfgvx_store_create(adfgvx_column_store *store, const char *path_prefix, int key_length)
+{
+    if (init_store(store, path_prefix) != 0 || key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+        return 2;
+
+    store->key_length = key_length;
+    if (open_segments(store, "w+b") != 0)
+        return 1;
+    if (write_manifest(store) != 0)
+    {
+        adfgvx_store_close(store);
+        return 1;
+    }
+    return 0;
+}
+
+int adfgvx_store_open(adfgvx_column_store *store, const char *path_prefix)
+{
+    char path[ADFGVX_STORE_PATH_MAX + 16];
+    int version;
+
+    if (init_store(store, path_prefix) != 0)
+        return 2;
+
+    store_path(store, ".manifest", -1, path);
+    FILE *manifest = fopen(path, "r");
+    if (manifest == NULL)
+        return 1;
+
+    int fields = fscanf(manifest, "ADFGVX-COLUMN-STORE %d key_length %d symbols %" SCNd64,
+                        &version, &store->key_length, &store->symbol_count);
+    fclose(manifest);
+
+    if (fields != 3 || version != 1 || store->key_length <= 0 || store->key_length >= MAX_KEY_LENGTH ||
+        store->symbol_count < 0 || store->symbol_count % 2 != 0)
+    {
+        return 2;
+    }
+
+    return open_segments(store, "r+b");
+}
+
+long adfgvx_store_encode_chunk(int key_length, int64_t first_symbol, const char *text, long length,
+                               char *grouped, long column_fill[])
+{
+    long column_start[MAX_KEY_LENGTH];
+    long valid = 0;
+    int col;
+
+    if (key_length <= 0 || key_length >= MAX_KEY_LENGTH || first_symbol < 0 || length < 0 ||
+        (text == NULL && length > 0) || grouped == NULL || column_fill == NULL)
+    {
+        return -1;
+    }
+
+    // 1) Conta os caracteres validos para saber quantos simbolos cada coluna recebe.
+    for (long i = 0; i < length; i++)
+    {
+        valid += adfgvx_grid_cell(text[i]) >= 0;
+    }
+
+    long symbol_count = 2 * valid;
+    int first_column = (int)(first_symbol % key_length);
+    long pos = 0;
+
+    for (int c = 0; c < key_length; c++)
+    {
+        // Simbolos j (0 <= j < symbol_count) com (first_column + j) % key_length == c.
+        int distance = (c - first_column + key_length) % key_length;
+        column_fill[c] = symbol_count / key_length + (distance < symbol_count % key_length ? 1 : 0);
+        column_start[c] = pos;
+        pos += column_fill[c];
+    }
+
+    // 2) Espalha os simbolos diretamente na regiao de cada coluna.
+    col = first_column;
+    for (long i = 0; i < length; i++)
+    {
+        char pair[2];
+        if (!adfgvx_grid_encode_char(text[i], &pair[0], &pair[1]))
+            continue; // Caracteres nao encontrados sao ignorados
+
+        for (int s = 0; s < 2; s++)
+        {
+            grouped[column_start[col]++] = pair[s];
+            if (++col == key_length)
+                col = 0;
+        }
+    }
+
+    return symbol_count;
+}
+
+/**
+ * @brief Grava um trecho agrupado no fim de cada segmento, apos os simbolos ja gravados
+ * (confirmados ou pendentes), sem sincronizar nem atualizar o manifesto.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de escrita.
+ */
+static int write_segments(adfgvx_column_store *store, const char *grouped, const long column_fill[], long symbol_count)
+{
+    int64_t written = store->symbol_count + store->pending_count;
+    long pos = 0;
+
+    for (int c = 0; c < store->key_length; c++)
+    {
+        // Posiciona o segmento logo apos o ultimo simbolo gravado; o excesso de uma gravacao
+        // interrompida (alem do manifesto) e sobrescrito.
+        if (file_seek_64(store->segment[c], column_length(written, store->key_length, c), SEEK_SET) != 0)
+            return 1;
+
+        if (column_fill[c] > 0 &&
+            fwrite(grouped + pos, 1, (size_t)column_fill[c], store->segment[c]) != (size_t)column_fill[c])
+        {
+            perror("Erro ao escrever segmento do armazenamento");
+            return 1;
+        }
+        pos += column_fill[c];
+    }
+
+    store->pending_count += symbol_count;
+    return 0;
+}
+
+int adfgvx_store_commit(adfgvx_column_store *store)
+{
+    if (store == NULL || store->segment[0] == NULL)
+        return 2;
+
+    // Os segmentos chegam ao disco antes de o manifesto passar a conta-los.
+    for (int c = 0; c < store->key_length; c++)
+    {
+        if (file_sync(store->segment[c]) != 0)
+        {
+            perror("Erro ao sincronizar segmento do armazenamento");
+            return 1;
+        }
+    }
+
+    int64_t committed = store->symbol_count;
+    store->symbol_count += store->pending_count;
+    if (write_manifest(store) != 0)
+    {
+        store->symbol_count = committed;
+        return 1;
+    }
+    store->pending_count = 0;
+    return 0;
+}
+
+int adfgvx_store_append_encoded(adfgvx_column_store *store, const char *grouped,
+                                const long column_fill[], long symbol_count)
+{
+    if (store == NULL || store->segment[0] == NULL || grouped == NULL || column_fill == NULL ||
+        symbol_count < 0 || symbol_count % 2 != 0)
+    {
+        return 2;
+    }
+
+    // Sem fsync nem manifesto: o produtor confirma uma vez, no fim do fluxo.
+    return write_segments(store, grouped, column_fill, symbol_count);
+}
+
+int adfgvx_store_append(adfgvx_column_store *store, const char *text, long length)
+{
+    // Simbolos do trecho atual, agrupados pela coluna original de destino.
+    char grouped[2 * APPEND_CHUNK];
+    long column_fill[MAX_KEY_LENGTH];
+
+    if (store == NULL || store->segment[0] == NULL || (text == NULL && length > 0) || length < 0)
+        return 2;
+
+    for (long start = 0; start < length; start += APPEND_CHUNK)
+    {
+        long n = length - start < APPEND_CHUNK ? length - start : APPEND_CHUNK;
+        long symbol_count = adfgvx_store_encode_chunk(store->key_length, store->symbol_count + store->pending_count,
+                                                      text + start, n, grouped, column_fill);
+        if (write_segments(store, grouped, column_fill, symbol_count) != 0)
+            return 1;
+    }
+
+    // Um unico fsync e uma unica atualizacao do manifesto por acrescimo.
+    return adfgvx_store_commit(store);
+}
+
+int adfgvx_store_write_ciphertext(adfgvx_column_store *store, const char *key, const char *filename)
+{
+    char buffer[COPY_BUFFER];
+    int order[MAX_KEY_LENGTH];
+    int key_length;
+
+    if (store == NULL || store->segment[0] == NULL || key == NULL || (int)strlen(key) != store->key_length)
+        return 2;
+    key_length = store->key_length;
+
+    adfgvx_key_order(key, key_length, order);
+
+    FILE *output_file_ptr = fopen(filename, "w");
+    if (output_file_ptr == NULL)
+    {
+        perror("Erro ao abrir arquivo para escrita da saida cifrada");
+        return 1;
+    }
+
+    for (int i = 0; i < key_length; i++)
+    {
+        FILE *segment = store->segment[order[i]];
+        int64_t remaining = column_length(store->symbol_count, key_length, order[i]);
+
+        if (file_seek_64(segment, 0, SEEK_SET) != 0)
+            remaining = -1;
+        while (remaining > 0)
+        {
+            size_t n = remaining < COPY_BUFFER ? (size_t)remaining : COPY_BUFFER;
+            if (fread(buffer, 1, n, segment) != n || fwrite(buffer, 1, n, output_file_ptr) != n)
+                break;
+            remaining -= (int64_t)n;
+        }
+        if (remaining != 0)
+        {
+            perror("Erro ao linearizar o armazenamento");
+            fclose(output_file_ptr);
+            return 1;
+        }
+    }
+
+    if (fclose(output_file_ptr) != 0)
+        return 1;
+    return 0;
+}
+
+int adfgvx_store_open_stream(adfgvx_column_store *store, const char *key, adfgvx_decipher_stream *stream)
+{
+    if (store == NULL || store->segment[0] == NULL)
+        return 2;
+    return adfgvx_stream_open_columns(stream, store->segment, store->symbol_count, key, store->key_length);
+}
+
+void adfgvx_store_close(adfgvx_column_store *store)
+{
+    if (store == NULL)
+        return;
+    for (int i = 0; i < MAX_KEY_LENGTH; i++)
+    {
+        if (store->segment[i] != NULL)
+        {
+            fclose(store->segment[i]);
+            store->segment[i] = NULL;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef ADFGVX_COLUMN_STORE_H
+#define ADFGVX_COLUMN_STORE_H
+
+#include <stdint.h> // Para int64_t
+#include <stdio.h>
+#include "cipher_config.h" // Para MAX_KEY_LENGTH
+#include "adfgvx_stream.h"
+
+// Tamanho maximo do prefixo de caminho de um armazenamento (incluindo o terminador nulo).
+#define ADFGVX_STORE_PATH_MAX 256
+
+/**
+ * @brief Armazenamento de texto cifrado segmentado por coluna, com suporte a acrescimos.
+ *
+ * O simbolo intermediario n vai sempre para a coluna original n % key_length, na linha
+ * n / key_length. Por isso acrescentar texto so estende o final de cada coluna: cada
+ * coluna original e um arquivo "<prefixo>.col<i>" que so cresce, e o manifesto
+ * "<prefixo>.manifest" guarda o comprimento da chave e o total de simbolos.
+ * A chave nao e gravada; ela so e necessaria para linearizar ou decifrar.
+ *
+ * Contagens e posicoes sao de 64 bits (int64_t), como no fluxo de adfgvx_stream.h, para que
+ * o armazenamento passe de 2 GB tambem onde long tem 32 bits (ex.: MinGW).
+ */
+typedef struct adfgvx_column_store
+{
+    char path_prefix[ADFGVX_STORE_PATH_MAX];
+    int key_length;
+    int64_t symbol_count;           // Total de simbolos confirmados no manifesto.
+    int64_t pending_count;          // Simbolos gravados nos segmentos, ainda fora do manifesto.
+    FILE *segment[MAX_KEY_LENGTH];  // Um segmento por coluna original, aberto para leitura e escrita.
+} adfgvx_column_store;
+
+/**
+ * @brief Cria um armazenamento vazio (sobrescreve um existente com o mesmo prefixo).
+ *
+ * @return int 0 em caso de sucesso, 1 se erro ao criar os arquivos, 2 se parametros invalidos.
+ */
+int adfgvx_store_create(adfgvx_column_store *store, const char *path_prefix, int key_length);
+
+/**
+ * @brief Abre um armazenamento existente lendo o seu manifesto.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir os arquivos, 2 se o manifesto for invalido.
+ */
+int adfgvx_store_open(adfgvx_column_store *store, const char *path_prefix);
+
+/**
+ * @brief Cifra e acrescenta texto ao armazenamento, com custo O(length).
+ * Caracteres fora da matriz sao ignorados, como em cipher_adfgvx().
+ *
+ * Os segmentos sao gravados e sincronizados (fsync) antes do manifesto, que e substituido
+ * de forma atomica (arquivo temporario + rename). Se o processo for interrompido, o
+ * manifesto continua valido, e o excesso nos segmentos e sobrescrito no proximo acrescimo.
+ *
+ * @param text Texto a ser acrescentado (nao precisa ser terminado em nulo).
+ * @param length Numero de caracteres em text.
+ * @return int 0 em caso de sucesso, 1 se erro de escrita, 2 se parametros invalidos.
+ */
+int adfgvx_store_append(adfgvx_column_store *store, const char *text, long length);
+
+/**
+ * @brief Etapa de calculo de um acrescimo: cifra um trecho e agrupa os simbolos por coluna.
+ * Nao faz E/S, o que permite sobrepor o calculo de um trecho com a gravacao do anterior.
+ *
+ * @param key_length Comprimento da chave do armazenamento.
+ * @param first_symbol Total de simbolos ja acrescentados antes deste trecho (so o resto da
+ * divisao por key_length e usado).
+ * @param text Trecho de texto (nao precisa ser terminado em nulo).
+ * @param length Numero de caracteres em text.
+ * @param grouped Saida com 2 * length posicoes: os simbolos da coluna 0, depois os da coluna 1, etc.
+ * @param column_fill Saida: quantos simbolos de grouped pertencem a cada coluna original.
+ * @return long Numero de simbolos gerados, ou -1 se parametros invalidos.
+ */
+long adfgvx_store_encode_chunk(int key_length, int64_t first_symbol, const char *text, long length,
+                               char *grouped, long column_fill[]);
+
+/**
+ * @brief Etapa de E/S de um acrescimo: grava nos segmentos um trecho produzido por
+ * adfgvx_store_encode_chunk() (com first_symbol igual ao total ja gravado no armazenamento).
+ * Nao sincroniza nem atualiza o manifesto: quem grava um fluxo de trechos chama
+ * adfgvx_store_commit() uma unica vez, no fim. Ate la, os trechos nao sao visiveis.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de escrita, 2 se parametros invalidos.
+ */
+int adfgvx_store_append_encoded(adfgvx_column_store *store, const char *grouped,
+                                const long column_fill[], long symbol_count);
+
+/**
+ * @brief Confirma os simbolos gravados desde a ultima confirmacao: sincroniza os segmentos
+ * no disco e so entao substitui o manifesto de forma atomica.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de escrita, 2 se parametros invalidos.
+ */
+int adfgvx_store_commit(adfgvx_column_store *store);
+
+/**
+ * @brief Grava o texto cifrado linear padrao (colunas na ordem alfabetica da chave, sem
+ * grupos), identico ao que write_encrypted_data_to_file() produziria com group_size 0 para
+ * todo o texto acrescentado.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de leitura ou escrita, 2 se parametros invalidos.
+ */
+int adfgvx_store_write_ciphertext(adfgvx_column_store *store, const char *key, const char *filename);
+
+/**
+ * @brief Abre uma decifragem em fluxo diretamente sobre os segmentos.
+ * O fluxo deve ser fechado antes de novos acrescimos ou do fechamento do armazenamento.
+ *
+ * @return int Mesmo retorno de adfgvx_stream_open_columns().
+ */
+int adfgvx_store_open_stream(adfgvx_column_store *store, const char *key, adfgvx_decipher_stream *stream);
+
+/**
+ * @brief Fecha os segmentos do armazenamento.
+ */
+void adfgvx_store_close(adfgvx_column_store *store);
+
+#endif // ADFGVX_COLUMN_STORE_H
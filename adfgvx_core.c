@@ -1,18 +1,8 @@
 #include "adfgvx_core.h"
+#include "adfgvx_grid.h" // Matriz e simbolos da cifra (adfgvx_grid_*)
 #include <string.h> // Necessrio para strlen, se usado (embora key_length seja passado)
 #include <stdio.h>  // Para debugging ou perror, se necessrio (geralmente evitado em mdulos core)
 
-// Constantes da cifra ADFGVX, encapsuladas neste mdulo.
-
-static const char symbols[6] = {'A', 'D', 'F', 'G', 'V', 'X'};
-static const char square[6][6] = {
-    {'A', 'B', 'C', 'D', 'E', 'F'},
-    {'G', 'H', 'I', 'J', 'K', 'L'},
-    {'M', 'N', 'O', 'P', 'Q', 'R'},
-    {'S', 'T', 'U', 'V', 'W', 'X'},
-    {'Y', 'Z', ' ', ',', '.', '1'},
-    {'2', '3', '4', '5', '6', '7'}};
-
 /**
  * @brief Encontra os simbolos ADFGVX correspondentes a um caractere.
  * Funo auxiliar esttica, interna a este mdulo.
@@ -24,19 +14,8 @@ static const char square[6][6] = {
  */
 static int get_adfgvx_symbols(char c, char *row, char *col)
 {
-    for (int i = 0; i < 6; i++)
-    {
-        for (int j = 0; j < 6; j++)
-        {
-            if (square[i][j] == c)
-            {
-                *row = symbols[i];
-                *col = symbols[j];
-                return 1;
-            }
-        }
-    }
-    return 0;
+    // Consulta direta nas tabelas geradas para a matriz escolhida em ADFGVX_GRID_SIZE.
+    return adfgvx_grid_encode_char(c, row, col);
 }
 
 /**
@@ -46,15 +25,16 @@ static int get_adfgvx_symbols(char c, char *row, char *col)
  * @param key_length Comprimento da chave.
  * @param symbol Simbolo a ser inserido (row ou col).
  * @param symbol_count Contador global de simbolos (sera incrementado).
- * @param encoded_symbol_matrix Matriz de saida contendo os simbolos organizados por coluna.
+ * @param encoded_symbols Matriz de saida contendo os simbolos organizados por coluna.
+ * @param column_capacity Posicoes por coluna em encoded_symbols.
  * @param symbols_per_column Vetor com a quantidade de simbolos por coluna (sera atualizado).
  */
-static void insert_symbol_to_column(int key_length, char symbol, int *symbol_count, char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH], int symbols_per_column[])
+static void insert_symbol_to_column(int key_length, char symbol, int *symbol_count, char *encoded_symbols, long column_capacity, int symbols_per_column[])
 {
     int col_index = (*symbol_count) % key_length;
     int write_pos = symbols_per_column[col_index];
 
-    encoded_symbol_matrix[col_index][write_pos] = symbol;
+    encoded_symbols[col_index * column_capacity + write_pos] = symbol;
     symbols_per_column[col_index]++;
     (*symbol_count)++;
 }
@@ -65,11 +45,12 @@ static void insert_symbol_to_column(int key_length, char symbol, int *symbol_cou
  *
  * @param key_length Comprimento da chave.
  * @param message Mensagem original a ser cifrada.
- * @param encoded_symbol_matrix Matriz onde os simbolos cifrados serao armazenados por coluna.
+ * @param encoded_symbols Matriz onde os simbolos cifrados serao armazenados por coluna.
+ * @param column_capacity Posicoes por coluna em encoded_symbols.
  * @param symbols_per_column Vetor que armazena o numero de elementos em cada coluna.
  * Este vetor deve ser zerado pelo chamador antes desta funo.
  */
-static void polybius_encode_to_columns(int key_length, char message[], char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH], int symbols_per_column[])
+static void polybius_encode_to_columns(int key_length, char message[], char *encoded_symbols, long column_capacity, int symbols_per_column[])
 {
     int i;
     int current_symbol_count = 0; // Renomeado de symbol_count para evitar shadowing se fosse global
@@ -84,21 +65,23 @@ static void polybius_encode_to_columns(int key_length, char message[], char enco
             continue;
         }
 
-        insert_symbol_to_column(key_length, r_symbol, &current_symbol_count, encoded_symbol_matrix, symbols_per_column);
-        insert_symbol_to_column(key_length, c_symbol, &current_symbol_count, encoded_symbol_matrix, symbols_per_column);
+        insert_symbol_to_column(key_length, r_symbol, &current_symbol_count, encoded_symbols, column_capacity, symbols_per_column);
+        insert_symbol_to_column(key_length, c_symbol, &current_symbol_count, encoded_symbols, column_capacity, symbols_per_column);
     }
 }
 
 /**
  * @brief Reorganiza as colunas da matriz com base na ordem alfabetica da chave.
+ * A ordem final das colunas e a mesma de adfgvx_key_order().
  * Funo auxiliar esttica, interna a este mdulo.
  *
  * @param key A chave usada na transposicao (array de caracteres).
  * @param key_length Comprimento da chave.
- * @param encoded_symbol_matrix Matriz com os dados cifrados por colunas.
+ * @param encoded_symbols Matriz com os dados cifrados por colunas.
+ * @param column_capacity Posicoes por coluna em encoded_symbols.
  * @param symbols_per_column Vetor com o numero de elementos em cada coluna.
  */
-static void transpose_columns_by_key_order(char key[], int key_length, char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH], int symbols_per_column[])
+static void transpose_columns_by_key_order(char key[], int key_length, char *encoded_symbols, long column_capacity, int symbols_per_column[])
 {
     int i, j, k;
     // Usa VLA (Variable Length Array) para sorted_key, requer C99 ou posterior.
@@ -125,14 +108,17 @@ static void transpose_columns_by_key_order(char key[], int key_length, char enco
                 sorted_key_chars[j] = sorted_key_chars[j + 1];
                 sorted_key_chars[j + 1] = temp_char;
 
-                // Troca as colunas correspondentes na encoded_symbol_matrix.
-                // A troca  feita para a coluna inteira (at MAX_MESSAGE_LENGTH).
-                // A leitura posterior ser limitada por symbols_per_column.
-                for (k = 0; k < MAX_MESSAGE_LENGTH; k++)
+                // Troca as colunas correspondentes em encoded_symbols.
+                // Apenas as posicoes ocupadas sao trocadas (a leitura posterior e limitada por
+                // symbols_per_column), e nao a coluna inteira de column_capacity posicoes.
+                int used_rows = symbols_per_column[j] > symbols_per_column[j + 1] ? symbols_per_column[j] : symbols_per_column[j + 1];
+                char *left = encoded_symbols + j * column_capacity;
+                char *right = left + column_capacity;
+                for (k = 0; k < used_rows; k++)
                 {
-                    char temp_matrix_char = encoded_symbol_matrix[j][k];
-                    encoded_symbol_matrix[j][k] = encoded_symbol_matrix[j + 1][k];
-                    encoded_symbol_matrix[j + 1][k] = temp_matrix_char;
+                    char temp_matrix_char = left[k];
+                    left[k] = right[k];
+                    right[k] = temp_matrix_char;
                 }
 
                 // Troca os contadores de simbolos para as colunas correspondentes
@@ -146,9 +132,44 @@ static void transpose_columns_by_key_order(char key[], int key_length, char enco
 
 // Implementao da funo pblica
 void cipher_adfgvx(char key[], int key_length, char message[], char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH], int symbols_per_column[])
+{
+    // As linhas da matriz sao contiguas: e o mesmo bloco com colunas de MAX_MESSAGE_LENGTH posicoes.
+    cipher_adfgvx_with_stride(key, key_length, message, &encoded_symbol_matrix[0][0], MAX_MESSAGE_LENGTH, symbols_per_column);
+}
+
+void adfgvx_key_order(const char *key, int key_length, int order[])
+{
+    for (int i = 0; i < key_length; i++)
+        order[i] = i;
+
+    // Mesmas comparacoes de transpose_columns_by_key_order(): so troca quando a letra da
+    // esquerda e maior, o que preserva a ordem original das letras repetidas.
+    for (int i = 0; i < key_length - 1; i++)
+    {
+        for (int j = 0; j < key_length - i - 1; j++)
+        {
+            if (key[order[j]] > key[order[j + 1]])
+            {
+                int tmp = order[j];
+                order[j] = order[j + 1];
+                order[j + 1] = tmp;
+            }
+        }
+    }
+}
+
+long cipher_adfgvx_column_capacity(long message_length, int key_length)
+{
+    if (key_length <= 0 || message_length <= 0)
+        return 1;
+    // Cada caractere gera no maximo dois simbolos, distribuidos em rodizio pelas colunas.
+    return (2 * message_length + key_length - 1) / key_length;
+}
+
+void cipher_adfgvx_with_stride(char key[], int key_length, char message[], char *encoded_symbols, long column_capacity, int symbols_per_column[])
 {
     //  responsabilidade do chamador (main) garantir que symbols_per_column
     // esteja inicializado com zeros antes de chamar esta funo.
-    polybius_encode_to_columns(key_length, message, encoded_symbol_matrix, symbols_per_column);
-    transpose_columns_by_key_order(key, key_length, encoded_symbol_matrix, symbols_per_column);
+    polybius_encode_to_columns(key_length, message, encoded_symbols, column_capacity, symbols_per_column);
+    transpose_columns_by_key_order(key, key_length, encoded_symbols, column_capacity, symbols_per_column);
 }
@@ -23,4 +23,36 @@ void cipher_adfgvx(char key[],
                    char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH],
                    int symbols_per_column[]);
 
+/**
+ * @brief Ordem alfabetica (estavel) das colunas da chave: order[i] e o indice original da
+ * coluna que aparece na i-esima posicao do texto cifrado. Letras repetidas mantem a ordem
+ * original, exatamente como o Bubble Sort de cipher_adfgvx(); todo modulo que le ou escreve
+ * colunas transpostas deve obter a ordem por aqui.
+ *
+ * @param order Vetor de saida com key_length posicoes.
+ */
+void adfgvx_key_order(const char *key, int key_length, int order[]);
+
+/**
+ * @brief Posicoes por coluna que bastam para cifrar uma mensagem de message_length caracteres
+ * com cipher_adfgvx_with_stride(): ceil(2 * message_length / key_length), no minimo 1.
+ */
+long cipher_adfgvx_column_capacity(long message_length, int key_length);
+
+/**
+ * @brief Igual a cipher_adfgvx(), com a matriz em um bloco contiguo de key_length colunas de
+ * column_capacity posicoes cada (a coluna i comeca em encoded_symbols + i * column_capacity).
+ * Permite dimensionar a matriz pela mensagem (cipher_adfgvx_column_capacity()), e nao por
+ * MAX_MESSAGE_LENGTH.
+ *
+ * @param encoded_symbols Bloco de key_length * column_capacity posicoes.
+ * @param column_capacity Posicoes por coluna (distancia entre o inicio de duas colunas).
+ */
+void cipher_adfgvx_with_stride(char key[],
+                               int key_length,
+                               char message[],
+                               char *encoded_symbols,
+                               long column_capacity,
+                               int symbols_per_column[]);
+
 #endif // ADFGVX_CORE_H
@@ -0,0 +1,264 @@
+#define _POSIX_C_SOURCE 200809L // Para clock_gettime
+#include "adfgvx_crib.h"
+#include "adfgvx_grid.h" // Matriz e simbolos da cifra (adfgvx_grid_*)
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Dados compartilhados (somente leitura) entre as threads.
+ */
+typedef struct crib_problem
+{
+    const char *ciphertext;
+    int key_length;
+    long column_length[MAX_KEY_LENGTH];   // Comprimento de cada coluna original.
+    char crib_symbols[2 * ADFGVX_CRIB_MAX_LENGTH];
+    int crib_symbol_count;
+    long offset_count;                    // Numero de posicoes possiveis do trecho.
+    double factorial[MAX_KEY_LENGTH + 1]; // factorial[n] = n!
+} crib_problem;
+
+/**
+ * @brief Estado de uma thread: restricoes da posicao atual e resultados parciais.
+ */
+typedef struct crib_worker
+{
+    const crib_problem *problem;
+    int first_offset;
+    int offset_step;
+    pthread_t thread;
+
+    // Restricoes da posicao atual, agrupadas pela coluna original: (linha, simbolo esperado).
+    long constraint_row[MAX_KEY_LENGTH][2 * ADFGVX_CRIB_MAX_LENGTH];
+    char constraint_symbol[MAX_KEY_LENGTH][2 * ADFGVX_CRIB_MAX_LENGTH];
+    int constraint_count[MAX_KEY_LENGTH];
+
+    long offset;
+    int order[MAX_KEY_LENGTH];
+    adfgvx_crib_report partial;
+} crib_worker;
+
+/**
+ * @brief Tempo de relogio (em segundos) para medir a vazao com varias threads.
+ * (Funcao auxiliar estatica)
+ */
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Registra uma ordenacao completa que satisfaz todas as restricoes.
+ * (Funcao auxiliar estatica)
+ */
+static void record_match(crib_worker *worker)
+{
+    int key_length = worker->problem->key_length;
+    adfgvx_crib_report *partial = &worker->partial;
+
+    partial->total_matches++;
+    if (partial->match_count == ADFGVX_CRIB_MAX_RESULTS)
+        return;
+
+    adfgvx_crib_match *match = &partial->matches[partial->match_count++];
+    match->offset = worker->offset;
+    for (int i = 0; i < key_length; i++)
+    {
+        match->order[i] = worker->order[i];
+        // A coluna original order[i] recebe a i-esima letra: a ordenacao da chave reproduz order[].
+        match->key[worker->order[i]] = (char)('A' + i);
+    }
+    match->key[key_length] = '\0';
+}
+
+/**
+ * @brief Atribui colunas as posicoes do texto cifrado em profundidade, podando prefixos invalidos.
+ * (Funcao auxiliar estatica)
+ *
+ * @param depth Posicao alfabetica sendo atribuida.
+ * @param start Inicio, no texto cifrado, da coluna atribuida nesta posicao.
+ * @param used Mascara de colunas originais ja atribuidas.
+ */
+static void search_orderings(crib_worker *worker, int depth, long start, unsigned used)
+{
+    const crib_problem *problem = worker->problem;
+    int key_length = problem->key_length;
+
+    if (depth == key_length)
+    {
+        record_match(worker);
+        return;
+    }
+
+    for (int c = 0; c < key_length; c++)
+    {
+        if (used & (1u << c))
+            continue;
+
+        worker->partial.nodes_visited++;
+
+        int consistent = 1;
+        for (int i = 0; i < worker->constraint_count[c]; i++)
+        {
+            if (problem->ciphertext[start + worker->constraint_row[c][i]] != worker->constraint_symbol[c][i])
+            {
+                consistent = 0;
+                break;
+            }
+        }
+
+        if (consistent)
+        {
+            worker->order[depth] = c;
+            search_orderings(worker, depth + 1, start + problem->column_length[c], used | (1u << c));
+        }
+    }
+}
+
+/**
+ * @brief Corpo de uma thread: testa as posicoes first_offset, first_offset + offset_step, ...
+ * (Funcao auxiliar estatica)
+ */
+static void *crib_worker_run(void *arg)
+{
+    crib_worker *worker = (crib_worker *)arg;
+    const crib_problem *problem = worker->problem;
+    int key_length = problem->key_length;
+
+    for (long offset = worker->first_offset; offset < problem->offset_count; offset += worker->offset_step)
+    {
+        worker->offset = offset;
+        memset(worker->constraint_count, 0, sizeof(worker->constraint_count));
+
+        // O simbolo intermediario n fica na coluna original n % key_length, linha n / key_length.
+        for (int j = 0; j < problem->crib_symbol_count; j++)
+        {
+            long n = 2 * offset + j;
+            int c = (int)(n % key_length);
+            worker->constraint_row[c][worker->constraint_count[c]] = n / key_length;
+            worker->constraint_symbol[c][worker->constraint_count[c]++] = problem->crib_symbols[j];
+        }
+
+        search_orderings(worker, 0, 0, 0);
+        // Espaco coberto: inclui os ramos podados, que nunca foram visitados.
+        worker->partial.space_covered += problem->factorial[key_length];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Comparador para ordenar as ordenacoes sobreviventes por posicao e depois por ordem.
+ * (Funcao auxiliar estatica)
+ */
+static int compare_matches(const void *a, const void *b)
+{
+    const adfgvx_crib_match *x = (const adfgvx_crib_match *)a;
+    const adfgvx_crib_match *y = (const adfgvx_crib_match *)b;
+
+    if (x->offset != y->offset)
+        return x->offset < y->offset ? -1 : 1;
+    return memcmp(x->order, y->order, sizeof(x->order));
+}
+
+int adfgvx_crib_search(const char *ciphertext, int key_length, const char *crib,
+                       int thread_count, adfgvx_crib_report *report)
+{
+    crib_problem problem;
+    crib_worker *workers;
+    int status = 0;
+
+    if (ciphertext == NULL || crib == NULL || report == NULL || thread_count <= 0 ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        return 2;
+    }
+    memset(report, 0, sizeof(*report));
+
+    long crib_length = (long)strlen(crib);
+    long total_symbols = (long)strlen(ciphertext);
+    if (crib_length == 0 || crib_length > ADFGVX_CRIB_MAX_LENGTH || total_symbols % 2 != 0)
+        return 2;
+
+    memset(&problem, 0, sizeof(problem));
+    problem.ciphertext = ciphertext;
+    problem.key_length = key_length;
+    for (long i = 0; i < crib_length; i++)
+    {
+        if (!adfgvx_grid_encode_char(crib[i], &problem.crib_symbols[2 * i], &problem.crib_symbols[2 * i + 1]))
+            return 2; // O trecho conhecido deve conter apenas caracteres da matriz.
+    }
+    problem.crib_symbol_count = (int)(2 * crib_length);
+
+    // Mesma aritmetica de reverse_transposition().
+    for (int c = 0; c < key_length; c++)
+        problem.column_length[c] = total_symbols / key_length + (c < total_symbols % key_length ? 1 : 0);
+
+    problem.offset_count = total_symbols / 2 - crib_length + 1;
+    problem.factorial[0] = 1.0;
+    for (int i = 1; i <= key_length; i++)
+        problem.factorial[i] = problem.factorial[i - 1] * i;
+
+    if (problem.offset_count <= 0)
+        return 0; // Trecho maior que a mensagem: nenhuma ordenacao possivel.
+    if (thread_count > problem.offset_count)
+        thread_count = (int)problem.offset_count;
+
+    workers = calloc((size_t)thread_count, sizeof(crib_worker));
+    if (workers == NULL)
+        return 1;
+
+    double start_time = wall_seconds();
+    int started = 0;
+    for (; started < thread_count; started++)
+    {
+        workers[started].problem = &problem;
+        workers[started].first_offset = started;
+        workers[started].offset_step = thread_count;
+        if (pthread_create(&workers[started].thread, NULL, crib_worker_run, &workers[started]) != 0)
+        {
+            status = 1;
+            break;
+        }
+    }
+
+    for (int t = 0; t < started; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+
+        adfgvx_crib_report *partial = &workers[t].partial;
+        report->total_matches += partial->total_matches;
+        report->space_covered += partial->space_covered;
+        report->nodes_visited += partial->nodes_visited;
+        for (int i = 0; i < partial->match_count; i++)
+        {
+            if (report->match_count < ADFGVX_CRIB_MAX_RESULTS)
+            {
+                report->matches[report->match_count++] = partial->matches[i];
+            }
+            else
+            {
+                // Mantem as ADFGVX_CRIB_MAX_RESULTS primeiras posicoes: substitui a maior, se for o caso.
+                int last = 0;
+                for (int m = 1; m < report->match_count; m++)
+                {
+                    if (compare_matches(&report->matches[m], &report->matches[last]) > 0)
+                        last = m;
+                }
+                if (compare_matches(&partial->matches[i], &report->matches[last]) < 0)
+                    report->matches[last] = partial->matches[i];
+            }
+        }
+    }
+
+    report->elapsed_seconds = wall_seconds() - start_time;
+    if (report->elapsed_seconds > 0)
+        report->nodes_per_second = report->nodes_visited / report->elapsed_seconds;
+    qsort(report->matches, (size_t)report->match_count, sizeof(adfgvx_crib_match), compare_matches);
+
+    free(workers);
+    return status;
+}
@@ -0,0 +1,58 @@
+#ifndef ADFGVX_CRIB_H
+#define ADFGVX_CRIB_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH
+
+// Numero padrao de threads usadas para distribuir as posicoes do trecho conhecido.
+#define ADFGVX_CRIB_THREADS 4
+
+// Comprimento maximo (em caracteres) do trecho conhecido.
+#define ADFGVX_CRIB_MAX_LENGTH 256
+
+// Numero maximo de ordenacoes sobreviventes guardadas no relatorio.
+#define ADFGVX_CRIB_MAX_RESULTS 64
+
+/**
+ * @brief Ordenacao de colunas compativel com o trecho conhecido.
+ */
+typedef struct adfgvx_crib_match
+{
+    long offset;                // Posicao (em caracteres) do trecho conhecido na mensagem.
+    int order[MAX_KEY_LENGTH];  // order[i] = coluna original que e a i-esima no texto cifrado.
+    char key[MAX_KEY_LENGTH];   // Chave canonica equivalente (ex.: "CAB"), aceita por decipher_adfgvx().
+} adfgvx_crib_match;
+
+/**
+ * @brief Resultado e metricas de uma busca com trecho conhecido.
+ */
+typedef struct adfgvx_crib_report
+{
+    adfgvx_crib_match matches[ADFGVX_CRIB_MAX_RESULTS]; // Ordenados por posicao.
+    int match_count;              // Ordenacoes guardadas em matches.
+    long total_matches;           // Ordenacoes sobreviventes (inclusive alem de ADFGVX_CRIB_MAX_RESULTS).
+    double space_covered;         // Pares (posicao, ordenacao) eliminados ou confirmados; nao e trabalho feito.
+    long nodes_visited;           // Atribuicoes parciais de colunas efetivamente testadas.
+    double elapsed_seconds;
+    double nodes_per_second;      // Vazao real: nodes_visited / elapsed_seconds.
+} adfgvx_crib_report;
+
+/**
+ * @brief Procura as ordenacoes da transposicao compativeis com um trecho conhecido da mensagem.
+ *
+ * Para cada posicao possivel do trecho, as colunas sao atribuidas as posicoes do texto
+ * cifrado uma a uma (em ordem alfabetica da chave). Como o inicio de cada coluna so depende
+ * das colunas ja atribuidas, os simbolos do trecho que caem nessa coluna podem ser conferidos
+ * imediatamente, e qualquer divergencia poda todas as ordenacoes com o mesmo prefixo. Nenhuma
+ * decifragem completa e feita. As posicoes sao distribuidas entre threads.
+ *
+ * @param ciphertext Texto cifrado linearizado (string terminada em nulo).
+ * @param key_length Comprimento da chave a testar (1 a MAX_KEY_LENGTH - 1).
+ * @param crib Trecho conhecido (apenas caracteres da matriz, ate ADFGVX_CRIB_MAX_LENGTH).
+ * @param thread_count Numero de threads (use ADFGVX_CRIB_THREADS na duvida).
+ * @param report Relatorio a ser preenchido.
+ * @return int 0 em caso de sucesso, 1 se nao foi possivel criar as threads, 2 se parametros invalidos.
+ */
+int adfgvx_crib_search(const char *ciphertext, int key_length, const char *crib,
+                       int thread_count, adfgvx_crib_report *report);
+
+#endif // ADFGVX_CRIB_H
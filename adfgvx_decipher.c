@@ -1,39 +1,28 @@
 #include "cipher_config.h"
 #include "adfgvx_decipher.h"
+#include "adfgvx_core.h" // Para adfgvx_key_order
+#include "adfgvx_grid.h" // Matriz e simbolos da cifra (adfgvx_grid_*)
+#include "adfgvx_workspace.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
-// Constantes symbols e square so necessrias para a decifragem
-// e so encapsuladas neste mdulo como static.
-static const char symbols[6] = {'A', 'D', 'F', 'G', 'V', 'X'};
-static const char square[6][6] = {
-    {'A', 'B', 'C', 'D', 'E', 'F'},
-    {'G', 'H', 'I', 'J', 'K', 'L'},
-    {'M', 'N', 'O', 'P', 'Q', 'R'},
-    {'S', 'T', 'U', 'V', 'W', 'X'},
-    {'Y', 'Z', ' ', ',', '.', '1'},
-    {'2', '3', '4', '5', '6', '7'}};
-
 /**
- * @brief Retorna o ndice de um smbolo ADFGVX dentro do vetor `symbols`.
+ * @brief Retorna o ndice de um smbolo ADFGVX dentro do alfabeto da cifra.
  * (Funo auxiliar esttica)
  */
 static int symbol_index(char c)
 {
-    for (int i = 0; i < 6; i++)
-    {
-        if (symbols[i] == c)
-            return i;
-    }
-    return -1; // Smbolo no encontrado
+    return adfgvx_grid_symbol_index(c); // -1 se o smbolo no for encontrado
 }
 
 /**
  * @brief Reconstri as colunas originais da cifra com base na chave de transposio.
  * (Funo auxiliar esttica - lgica fornecida pelo utilizador)
+ *
+ * A coluna c ocupa columns[c * column_stride ...]; column_stride deve comportar a coluna mais longa.
  */
-static void reverse_transposition(char *input, char *key, int key_length, char columns[][MAX_MESSAGE_LENGTH], int col_counts[])
+static void reverse_transposition(char *input, char *key, int key_length, char *columns, int column_stride, int col_counts[])
 {
     if (key_length <= 0) { // Proteo contra key_length invlido
         // Zera col_counts se key_length for invlido para evitar uso de dados no inicializados
@@ -50,23 +39,11 @@ static void reverse_transposition(char *input, char *key, int key_length, char c
     int rows = len / key_length;
     int extra = len % key_length;
 
-    // 1) monta o vetor order[] = {0,1,2,...,key_length-1}
+    // 1) e 2) monta o vetor order[] = {0,1,2,...,key_length-1} e o ordena de acordo com
+    //    key[order[j]], para obter a ordem alfabtica dos ndices originais da chave
+    //    (a mesma ordem estvel usada na cifragem, ver adfgvx_key_order()).
     int order[key_length]; // VLA
-    for (int i = 0; i < key_length; i++) {
-        order[i] = i;
-    }
-
-    // 2) ordena order[] de acordo com key[order[j]], para obter a ordem alfabtica
-    //    dos ndices originais da chave.
-    for (int i = 0; i < key_length - 1; i++) {
-        for (int j = 0; j < key_length - i - 1; j++) {
-            if (key[order[j]] > key[order[j + 1]]) {
-                int tmp = order[j];
-                order[j] = order[j + 1];
-                order[j + 1] = tmp;
-            }
-        }
-    }
+    adfgvx_key_order(key, key_length, order);
     // Agora order[i] = ndice original da i-sima coluna EM ORDEM ALFABTICA da chave.
 
     // 3) determina quantos smbolos cada coluna (identificada pelo seu ndice original) vai ter.
@@ -141,7 +118,7 @@ static void reverse_transposition(char *input, char *key, int key_length, char c
 
         for (int j = 0; j < num_chars_for_this_col; j++) {
             if (pos < len) {
-                columns[original_col_index_to_fill][j] = input[pos++];
+                columns[original_col_index_to_fill * column_stride + j] = input[pos++];
             } else {
                 // Erro: input mais curto que o esperado pelos comprimentos das colunas.
                 // Preencher o resto com nulos ou retornar erro?
@@ -157,7 +134,7 @@ static void reverse_transposition(char *input, char *key, int key_length, char c
  * @brief Reverte a organizacao em colunas, reconstruindo a sequencia de simbolos linha a linha.
  * (Funcao auxiliar estatica - logica do utilizador)
  */
-static void reverse_polybius(char columns[][MAX_MESSAGE_LENGTH], int col_counts[], int key_length, char *output)
+static void reverse_polybius(char *columns, int column_stride, int col_counts[], int key_length, char *output, int output_size)
 {
     if (key_length <= 0 || !output) {
         if (output) output[0] = '\0';
@@ -178,8 +155,8 @@ static void reverse_polybius(char columns[][MAX_MESSAGE_LENGTH], int col_counts[
         {
             if (r < col_counts[c]) // Se a coluna 'c' tiver um simbolo na linha 'r'
             {
-                if (pos < MAX_MESSAGE_LENGTH * 2) { // Protege o buffer de saida 'output' (rearranged)
-                    output[pos++] = columns[c][r];
+                if (pos < output_size - 1) { // Protege o buffer de saida 'output' (rearranged)
+                    output[pos++] = columns[c * column_stride + r];
                 } else {
                     if (output) output[pos] = '\0'; // Tenta terminar a string
                     return; // Buffer de saida cheio
@@ -213,7 +190,7 @@ static void decode_symbols(char *pairs, char *message)
         if (row >= 0 && col >= 0) // Se o par de simbolos e valido
         {
             if (msg_index < MAX_MESSAGE_LENGTH - 1) { // Protege o buffer de saida 'message'
-                message[msg_index++] = square[row][col];
+                message[msg_index++] = adfgvx_grid_square[row * ADFGVX_GRID_SIZE + col];
             } else {
                 break; // Buffer de mensagem cheio
             }
@@ -226,34 +203,59 @@ static void decode_symbols(char *pairs, char *message)
     message[msg_index] = '\0'; // Termina a string da mensagem decifrada
 }
 
-// Implementacao da funcao publica
-void decipher_adfgvx(char *encrypted_text, char *key, int key_length, char *output)
+long decipher_adfgvx_workspace_size(long text_length, int key_length)
+{
+    if (text_length <= 0 || key_length <= 0)
+        return 0;
+
+    long column_stride = (text_length + key_length - 1) / key_length; // Coluna mais longa.
+    return adfgvx_workspace_region_size(column_stride * key_length) +
+           adfgvx_workspace_region_size(text_length + 1);
+}
+
+int decipher_adfgvx_with_workspace(adfgvx_workspace *workspace, char *encrypted_text, char *key, int key_length,
+                                   char *output)
 {
     // Validacao basica de parametros
-    if (!encrypted_text || !key || !output || key_length <= 0 || key_length >= MAX_KEY_LENGTH) {
+    if (!encrypted_text || !key || !output || !workspace || key_length <= 0 || key_length >= MAX_KEY_LENGTH) {
         if (output) output[0] = '\0';
-        return;
+        return 2;
     }
-    if (strlen(encrypted_text) == 0) {
+    long text_length = (long)strlen(encrypted_text);
+    if (text_length == 0) {
         output[0] = '\0';
-        return;
+        return 0;
     }
 
-    // VLAs para 'columns' e 'col_counts'.
-    char columns[key_length][MAX_MESSAGE_LENGTH];
+    // Colunas e sequencia reordenada dimensionadas pelo texto recebido, nao por MAX_MESSAGE_LENGTH.
+    // Nada precisa ser zerado: reverse_transposition() preenche exatamente col_counts[c]
+    // simbolos de cada coluna, e apenas eles sao lidos depois.
+    int column_stride = (int)((text_length + key_length - 1) / key_length);
+    adfgvx_workspace_reset(workspace);
+    if (adfgvx_workspace_reserve(workspace, decipher_adfgvx_workspace_size(text_length, key_length)) != 0) {
+        output[0] = '\0';
+        return 1;
+    }
+    char *columns = adfgvx_workspace_alloc(workspace, (long)column_stride * key_length);
+    char *rearranged_symbols = adfgvx_workspace_alloc(workspace, text_length + 1); // +1 para o nulo
     int col_counts[key_length];
-    //  crucial zerar col_counts e columns antes de us-los,
-    // especialmente porque reverse_transposition pode no preencher todas as partes se len for 0.
     memset(col_counts, 0, key_length * sizeof(int));
-    for(int i=0; i<key_length; ++i) {
-        memset(columns[i], 0, MAX_MESSAGE_LENGTH * sizeof(char));
-    }
-
-    // Buffer para a sequencia de simbolos apos reverter a transposicao.
-    // O tamanho mximo  o mesmo do texto cifrado (que pode ser at MAX_MESSAGE_LENGTH * 2).
-    char rearranged_symbols[MAX_MESSAGE_LENGTH * 2 + 1]; // +1 para o nulo
 
-    reverse_transposition(encrypted_text, key, key_length, columns, col_counts);
-    reverse_polybius(columns, col_counts, key_length, rearranged_symbols);
+    reverse_transposition(encrypted_text, key, key_length, columns, column_stride, col_counts);
+    reverse_polybius(columns, column_stride, col_counts, key_length, rearranged_symbols, (int)text_length + 1);
     decode_symbols(rearranged_symbols, output);
+    adfgvx_workspace_reset(workspace);
+    return 0;
+}
+
+// Implementacao da funcao publica
+void decipher_adfgvx(char *encrypted_text, char *key, int key_length, char *output)
+{
+    adfgvx_workspace *workspace = adfgvx_thread_workspace();
+
+    if (workspace == NULL) {
+        if (output) output[0] = '\0';
+        return;
+    }
+    decipher_adfgvx_with_workspace(workspace, encrypted_text, key, key_length, output);
 }
@@ -1,6 +1,8 @@
 #ifndef ADFGVX_DECIPHER_H
 #define ADFGVX_DECIPHER_H
 
+#include "adfgvx_workspace.h" // Para adfgvx_workspace
+
 // cipher_config.h  includo por adfgvx_decipher.c ou main,
 // mas no  estritamente necessrio aqui se MAX_MESSAGE_LENGTH no estiver no prottipo.
 // No entanto, a funo decipher_adfgvx implicitamente depende de MAX_MESSAGE_LENGTH
@@ -18,7 +20,27 @@
  * @param output Buffer onde a mensagem decodificada ser armazenada (deve ser grande o suficiente,
  * tipicamente MAX_MESSAGE_LENGTH conforme definido em cipher_config.h).
  * A funo garante a terminao nula do buffer de sada.
+ *
+ * Os buffers temporarios vem da area de trabalho da thread (adfgvx_thread_workspace()),
+ * dimensionada pelo texto recebido: chamadas repetidas nao alocam memoria depois que a area
+ * atinge o tamanho do maior texto.
  */
 void decipher_adfgvx(char *encrypted_text, char *key, int key_length, char *output);
 
+/**
+ * @brief Memoria de trabalho (em bytes) que decipher_adfgvx_with_workspace() reserva para um
+ * texto cifrado de text_length simbolos e uma chave de key_length caracteres.
+ */
+long decipher_adfgvx_workspace_size(long text_length, int key_length);
+
+/**
+ * @brief Igual a decipher_adfgvx(), usando a area de trabalho fornecida pelo chamador.
+ * A area e reiniciada no inicio e no fim; se a capacidade ja bastar
+ * (decipher_adfgvx_workspace_size()), nenhuma memoria e alocada.
+ *
+ * @return int 0 em caso de sucesso, 1 se faltar memoria para a area, 2 se parametros invalidos.
+ */
+int decipher_adfgvx_with_workspace(adfgvx_workspace *workspace, char *encrypted_text, char *key, int key_length,
+                                   char *output);
+
 #endif // ADFGVX_DECIPHER_H
@@ -0,0 +1,362 @@
+#include "adfgvx_dispatch.h"
+#include "adfgvx_core.h"
+#include "adfgvx_decipher.h"
+#include "adfgvx_batch.h"
+#include "adfgvx_stream.h"
+#include "adfgvx_workspace.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Maior comprimento de mensagem coberto por cada faixa do perfil.
+static const int bucket_limits[ADFGVX_PROFILE_BUCKETS] = {16, 64, 256, 1024, MAX_MESSAGE_LENGTH - 1};
+
+// Nomes usados no arquivo de perfil, indexados pelos enums de adfgvx_dispatch.h.
+static const char *const cipher_path_names[ADFGVX_CIPHER_PATH_COUNT] = {"matrix", "closed_form"};
+static const char *const decipher_path_names[ADFGVX_DECIPHER_PATH_COUNT] = {"matrix", "stream"};
+
+// Texto usado para montar as mensagens de calibracao (apenas caracteres da matriz).
+static const char calibration_text[] = "ATAQUE AO AMANHECER, 1234567 UNIDADES. ";
+static const char calibration_key[] = "CHAVE123";
+
+int adfgvx_profile_bucket_limit(int bucket)
+{
+    if (bucket < 0 || bucket >= ADFGVX_PROFILE_BUCKETS)
+        return -1;
+    return bucket_limits[bucket];
+}
+
+/**
+ * @brief Retorna a faixa do perfil que cobre uma mensagem de `length` caracteres.
+ * (Funcao auxiliar estatica)
+ */
+static int bucket_for_length(long length)
+{
+    for (int b = 0; b < ADFGVX_PROFILE_BUCKETS - 1; b++)
+    {
+        if (length <= bucket_limits[b])
+            return b;
+    }
+    return ADFGVX_PROFILE_BUCKETS - 1;
+}
+
+void adfgvx_profile_set_default(adfgvx_profile *profile)
+{
+    for (int k = 0; k < MAX_KEY_LENGTH; k++)
+    {
+        for (int b = 0; b < ADFGVX_PROFILE_BUCKETS; b++)
+        {
+            profile->cipher_path[k][b] = ADFGVX_CIPHER_PATH_CLOSED_FORM;
+            profile->decipher_path[k][b] = ADFGVX_DECIPHER_PATH_MATRIX;
+        }
+    }
+}
+
+int cipher_adfgvx_with_path(adfgvx_cipher_path path, const char *key, int key_length,
+                            const char *message, char *output, int output_size)
+{
+    if (key == NULL || message == NULL || output == NULL || output_size <= 0 ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        return 2;
+    }
+
+    if (path == ADFGVX_CIPHER_PATH_MATRIX)
+    {
+        long message_length = (long)strlen(message);
+
+        // A matriz e dimensionada pela mensagem: key_length colunas de ceil(2n / key_length)
+        // posicoes. Ela e a copia da mensagem ficam na area de trabalho da thread, e nao na pilha.
+        adfgvx_workspace *workspace = adfgvx_thread_workspace();
+        long column_capacity = cipher_adfgvx_column_capacity(message_length, key_length);
+        long matrix_bytes = (long)key_length * column_capacity;
+        if (workspace == NULL)
+            return 1;
+        adfgvx_workspace_reset(workspace);
+        if (adfgvx_workspace_reserve(workspace, adfgvx_workspace_region_size(matrix_bytes) +
+                                                    adfgvx_workspace_region_size(message_length + 1)) != 0)
+        {
+            return 1;
+        }
+
+        char key_copy[MAX_KEY_LENGTH];
+        char *encoded_symbols = adfgvx_workspace_alloc(workspace, matrix_bytes);
+        char *message_copy = adfgvx_workspace_alloc(workspace, message_length + 1);
+        int symbols_per_column[MAX_KEY_LENGTH] = {0};
+        int pos = 0;
+
+        memcpy(key_copy, key, key_length);
+        memcpy(message_copy, message, message_length + 1);
+        cipher_adfgvx_with_stride(key_copy, key_length, message_copy, encoded_symbols, column_capacity,
+                                  symbols_per_column);
+
+        for (int i = 0; i < key_length; i++)
+        {
+            if (pos + symbols_per_column[i] >= output_size)
+            {
+                output[0] = '\0';
+                adfgvx_workspace_reset(workspace);
+                return 1;
+            }
+            memcpy(output + pos, encoded_symbols + i * column_capacity, symbols_per_column[i]);
+            pos += symbols_per_column[i];
+        }
+        output[pos] = '\0';
+        adfgvx_workspace_reset(workspace);
+        return 0;
+    }
+
+    if (path == ADFGVX_CIPHER_PATH_CLOSED_FORM)
+    {
+        long offsets[2];
+        int status = cipher_adfgvx_batch(key, key_length, &message, 1, output, output_size - 1, offsets);
+        output[status == 0 ? offsets[1] : 0] = '\0';
+        return status;
+    }
+
+    return 2;
+}
+
+void decipher_adfgvx_with_path(adfgvx_decipher_path path, const char *encrypted_text,
+                               const char *key, int key_length, char *output)
+{
+    if (output == NULL)
+        return;
+
+    if (path == ADFGVX_DECIPHER_PATH_MATRIX)
+    {
+        // decipher_adfgvx() nao altera a entrada nem a chave.
+        decipher_adfgvx((char *)encrypted_text, (char *)key, key_length, output);
+        return;
+    }
+
+    output[0] = '\0';
+    if (path == ADFGVX_DECIPHER_PATH_STREAM && encrypted_text != NULL)
+    {
+        adfgvx_decipher_stream stream;
+        int total = 0, n;
+
+        if (adfgvx_stream_open_memory(&stream, encrypted_text, (long)strlen(encrypted_text), key, key_length) != 0)
+            return;
+        while (total < MAX_MESSAGE_LENGTH - 1 &&
+               (n = adfgvx_stream_read(&stream, output + total, MAX_MESSAGE_LENGTH - 1 - total)) > 0)
+        {
+            total += n;
+        }
+        adfgvx_stream_close(&stream);
+        output[total] = '\0';
+    }
+}
+
+int cipher_adfgvx_auto(const adfgvx_profile *profile, const char *key, int key_length,
+                       const char *message, char *output, int output_size)
+{
+    adfgvx_cipher_path path = ADFGVX_CIPHER_PATH_CLOSED_FORM;
+
+    if (profile != NULL && message != NULL && key_length > 0 && key_length < MAX_KEY_LENGTH)
+    {
+        long message_length = (long)strlen(message);
+        path = (adfgvx_cipher_path)profile->cipher_path[key_length][bucket_for_length(message_length)];
+    }
+    return cipher_adfgvx_with_path(path, key, key_length, message, output, output_size);
+}
+
+void decipher_adfgvx_auto(const adfgvx_profile *profile, const char *encrypted_text,
+                          const char *key, int key_length, char *output)
+{
+    adfgvx_decipher_path path = ADFGVX_DECIPHER_PATH_STREAM;
+
+    if (profile != NULL && encrypted_text != NULL && key_length > 0 && key_length < MAX_KEY_LENGTH)
+    {
+        long symbol_count = (long)strlen(encrypted_text);
+        path = (adfgvx_decipher_path)profile->decipher_path[key_length][bucket_for_length(symbol_count / 2)];
+    }
+    decipher_adfgvx_with_path(path, encrypted_text, key, key_length, output);
+}
+
+/**
+ * @brief Mede o tempo medio (em segundos) de uma cifragem, repetindo ate atingir
+ * ADFGVX_CALIBRATION_MIN_SECONDS.
+ * (Funcao auxiliar estatica)
+ */
+static double time_cipher(adfgvx_cipher_path path, const char *key, int key_length,
+                          const char *message, char *output, int output_size)
+{
+    long reps = 1;
+    for (;;)
+    {
+        clock_t start_time = clock();
+        for (long r = 0; r < reps; r++)
+            cipher_adfgvx_with_path(path, key, key_length, message, output, output_size);
+        double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+        if (elapsed >= ADFGVX_CALIBRATION_MIN_SECONDS)
+            return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+/**
+ * @brief Mede o tempo medio (em segundos) de uma decifragem.
+ * (Funcao auxiliar estatica)
+ */
+static double time_decipher(adfgvx_decipher_path path, const char *encrypted_text,
+                            const char *key, int key_length, char *output)
+{
+    long reps = 1;
+    for (;;)
+    {
+        clock_t start_time = clock();
+        for (long r = 0; r < reps; r++)
+            decipher_adfgvx_with_path(path, encrypted_text, key, key_length, output);
+        double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+        if (elapsed >= ADFGVX_CALIBRATION_MIN_SECONDS)
+            return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+void adfgvx_calibrate(adfgvx_profile *profile, int verbose)
+{
+    static char message[MAX_MESSAGE_LENGTH];
+    static char encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    static char decrypted[MAX_MESSAGE_LENGTH];
+    int text_length = (int)strlen(calibration_text);
+
+    adfgvx_profile_set_default(profile);
+
+    for (int b = 0; b < ADFGVX_PROFILE_BUCKETS; b++)
+    {
+        int length = bucket_limits[b];
+        for (int i = 0; i < length; i++)
+            message[i] = calibration_text[i % text_length];
+        message[length] = '\0';
+
+        for (int k = 1; k < MAX_KEY_LENGTH; k++)
+        {
+            double best = -1.0;
+            for (int p = 0; p < ADFGVX_CIPHER_PATH_COUNT; p++)
+            {
+                double t = time_cipher((adfgvx_cipher_path)p, calibration_key, k, message, encrypted, sizeof(encrypted));
+                if (verbose)
+                    printf("\tcipher   chave=%d msg<=%-4d %-12s %10.3f us\n", k, length, cipher_path_names[p], t * 1e6);
+                if (best < 0 || t < best)
+                {
+                    best = t;
+                    profile->cipher_path[k][b] = (unsigned char)p;
+                }
+            }
+
+            cipher_adfgvx_with_path(ADFGVX_CIPHER_PATH_CLOSED_FORM, calibration_key, k, message, encrypted, sizeof(encrypted));
+            best = -1.0;
+            for (int p = 0; p < ADFGVX_DECIPHER_PATH_COUNT; p++)
+            {
+                double t = time_decipher((adfgvx_decipher_path)p, encrypted, calibration_key, k, decrypted);
+                if (verbose)
+                    printf("\tdecipher chave=%d msg<=%-4d %-12s %10.3f us\n", k, length, decipher_path_names[p], t * 1e6);
+                if (best < 0 || t < best)
+                {
+                    best = t;
+                    profile->decipher_path[k][b] = (unsigned char)p;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Procura um nome de implementacao em uma tabela de nomes.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int Indice do nome, ou -1 se nao encontrado.
+ */
+static int find_path_name(const char *const names[], int count, const char *name)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int adfgvx_profile_load(adfgvx_profile *profile, const char *filename)
+{
+    char line[128];
+    FILE *file_ptr = fopen(filename, "r");
+    if (file_ptr == NULL)
+    {
+        return 1;
+    }
+
+    adfgvx_profile_set_default(profile);
+
+    while (fgets(line, sizeof(line), file_ptr) != NULL)
+    {
+        char operation[16], path_name[32];
+        int key_length, limit, bucket, path;
+
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        if (sscanf(line, "%15s %d %d %31s", operation, &key_length, &limit, path_name) != 4 ||
+            key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+        {
+            fclose(file_ptr);
+            return 2;
+        }
+
+        for (bucket = 0; bucket < ADFGVX_PROFILE_BUCKETS && bucket_limits[bucket] != limit; bucket++)
+            ;
+
+        if (strcmp(operation, "cipher") == 0)
+            path = find_path_name(cipher_path_names, ADFGVX_CIPHER_PATH_COUNT, path_name);
+        else if (strcmp(operation, "decipher") == 0)
+            path = find_path_name(decipher_path_names, ADFGVX_DECIPHER_PATH_COUNT, path_name);
+        else
+            path = -1;
+
+        if (bucket == ADFGVX_PROFILE_BUCKETS || path < 0)
+        {
+            fclose(file_ptr);
+            return 2;
+        }
+
+        if (operation[0] == 'c')
+            profile->cipher_path[key_length][bucket] = (unsigned char)path;
+        else
+            profile->decipher_path[key_length][bucket] = (unsigned char)path;
+    }
+
+    fclose(file_ptr);
+    return 0;
+}
+
+int adfgvx_profile_save(const adfgvx_profile *profile, const char *filename)
+{
+    FILE *output_file_ptr = fopen(filename, "w");
+    if (output_file_ptr == NULL)
+    {
+        perror("Erro ao abrir arquivo para escrita do perfil de calibracao");
+        return 1;
+    }
+
+    fprintf(output_file_ptr, "# Perfil de calibracao ADFGVX (gerado por adfgvx_calibrate)\n");
+    fprintf(output_file_ptr, "# operacao comprimento_chave limite_mensagem implementacao\n");
+    for (int k = 1; k < MAX_KEY_LENGTH; k++)
+    {
+        for (int b = 0; b < ADFGVX_PROFILE_BUCKETS; b++)
+        {
+            fprintf(output_file_ptr, "cipher %d %d %s\n", k, bucket_limits[b],
+                    cipher_path_names[profile->cipher_path[k][b]]);
+            fprintf(output_file_ptr, "decipher %d %d %s\n", k, bucket_limits[b],
+                    decipher_path_names[profile->decipher_path[k][b]]);
+        }
+    }
+
+    if (fclose(output_file_ptr) != 0)
+    {
+        perror("Erro ao escrever o perfil de calibracao");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#ifndef ADFGVX_DISPATCH_H
+#define ADFGVX_DISPATCH_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH, MAX_MESSAGE_LENGTH
+
+// Numero de faixas de comprimento de mensagem registradas no perfil.
+#define ADFGVX_PROFILE_BUCKETS 5
+
+// Tempo minimo (em segundos) de cada medicao durante a calibracao.
+#define ADFGVX_CALIBRATION_MIN_SECONDS 0.002
+
+/**
+ * @brief Implementacoes disponiveis da cifragem.
+ */
+typedef enum
+{
+    ADFGVX_CIPHER_PATH_MATRIX = 0,  // cipher_adfgvx_with_stride(): matriz de colunas + troca de colunas.
+    ADFGVX_CIPHER_PATH_CLOSED_FORM, // cipher_adfgvx_batch(): escrita direta na posicao final.
+    ADFGVX_CIPHER_PATH_COUNT
+} adfgvx_cipher_path;
+
+/**
+ * @brief Implementacoes disponiveis da decifragem.
+ */
+typedef enum
+{
+    ADFGVX_DECIPHER_PATH_MATRIX = 0, // decipher_adfgvx(): reconstrucao das colunas em matriz.
+    ADFGVX_DECIPHER_PATH_STREAM,     // adfgvx_stream: cursores por coluna sobre o texto em memoria.
+    ADFGVX_DECIPHER_PATH_COUNT
+} adfgvx_decipher_path;
+
+/**
+ * @brief Perfil de calibracao: implementacao mais rapida por comprimento de chave e
+ * faixa de comprimento de mensagem. Os limites das faixas sao fixos
+ * (ver adfgvx_profile_bucket_limit()).
+ */
+typedef struct adfgvx_profile
+{
+    unsigned char cipher_path[MAX_KEY_LENGTH][ADFGVX_PROFILE_BUCKETS];
+    unsigned char decipher_path[MAX_KEY_LENGTH][ADFGVX_PROFILE_BUCKETS];
+} adfgvx_profile;
+
+/**
+ * @brief Retorna o maior comprimento de mensagem (em caracteres) coberto por uma faixa.
+ */
+int adfgvx_profile_bucket_limit(int bucket);
+
+/**
+ * @brief Preenche o perfil com as escolhas padrao (usado quando nao ha calibracao).
+ */
+void adfgvx_profile_set_default(adfgvx_profile *profile);
+
+/**
+ * @brief Mede cada implementacao nesta maquina e registra a mais rapida em cada faixa.
+ *
+ * @param profile Perfil a ser preenchido.
+ * @param verbose Se diferente de zero, imprime os tempos medidos em stdout.
+ */
+void adfgvx_calibrate(adfgvx_profile *profile, int verbose);
+
+/**
+ * @brief Le um perfil salvo por adfgvx_profile_save().
+ * Faixas ausentes no arquivo mantem a escolha padrao.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir o arquivo, 2 se o conteudo for invalido.
+ */
+int adfgvx_profile_load(adfgvx_profile *profile, const char *filename);
+
+/**
+ * @brief Salva o perfil em um arquivo texto, uma faixa por linha.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir ou escrever no arquivo.
+ */
+int adfgvx_profile_save(const adfgvx_profile *profile, const char *filename);
+
+/**
+ * @brief Cifra uma mensagem usando uma implementacao especifica.
+ *
+ * @param path Implementacao a ser usada.
+ * @param key Chave de cifra.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @param message Mensagem (string terminada em nulo, de qualquer tamanho; a matriz do caminho
+ * ADFGVX_CIPHER_PATH_MATRIX e dimensionada pelo seu comprimento).
+ * @param output Buffer para o texto cifrado linearizado (terminado em nulo).
+ * @param output_size Capacidade de output (2 * strlen(message) + 1 cobre qualquer mensagem).
+ * @return int 0 em caso de sucesso, 1 se output for pequeno demais ou faltar memoria, 2 se
+ * parametros invalidos.
+ */
+int cipher_adfgvx_with_path(adfgvx_cipher_path path, const char *key, int key_length,
+                            const char *message, char *output, int output_size);
+
+/**
+ * @brief Decifra um texto usando uma implementacao especifica.
+ * Mesmo contrato de decipher_adfgvx(): output deve ter MAX_MESSAGE_LENGTH posicoes. Os dois
+ * caminhos aceitam textos de qualquer tamanho e param apos MAX_MESSAGE_LENGTH - 1 caracteres
+ * decifrados, entao qualquer um pode ser escolhido para qualquer faixa do perfil.
+ */
+void decipher_adfgvx_with_path(adfgvx_decipher_path path, const char *encrypted_text,
+                               const char *key, int key_length, char *output);
+
+/**
+ * @brief Cifra uma mensagem com a implementacao indicada pelo perfil para o seu tamanho.
+ * Mesmos parametros e retorno de cipher_adfgvx_with_path().
+ */
+int cipher_adfgvx_auto(const adfgvx_profile *profile, const char *key, int key_length,
+                       const char *message, char *output, int output_size);
+
+/**
+ * @brief Decifra um texto com a implementacao indicada pelo perfil para o seu tamanho.
+ * Mesmo contrato de decipher_adfgvx().
+ */
+void decipher_adfgvx_auto(const adfgvx_profile *profile, const char *encrypted_text,
+                          const char *key, int key_length, char *output);
+
+#endif // ADFGVX_DISPATCH_H
@@ -0,0 +1,295 @@
+#include "adfgvx_format.h"
+#include "adfgvx_grid.h" // Alfabeto de simbolos (adfgvx_grid_symbols, adfgvx_grid_symbol_index)
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSSE3__) || defined(__GNUC__)
+#include <tmmintrin.h> // _mm_shuffle_epi8 (pshufb); com GCC/Clang, escolhido em tempo de execucao
+#define ADFGVX_FORMAT_SSSE3 1
+#endif
+#endif
+
+/**
+ * @brief Indica se um caractere e separador de grupos ou de linhas.
+ * (Funcao auxiliar estatica)
+ */
+static int is_separator(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Compacta input[from..to) caractere a caractere, acrescentando os simbolos em output + *n.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 2 se houver um caractere invalido (posicao em *invalid_offset).
+ */
+static int ingest_scalar(const char *input, long from, long to, char *output, long *n,
+                         long *invalid_offset)
+{
+    for (long i = from; i < to; i++)
+    {
+        char c = input[i];
+        if (adfgvx_grid_symbol_index(c) >= 0)
+        {
+            output[(*n)++] = c;
+        }
+        else if (!is_separator(c))
+        {
+            if (invalid_offset != NULL)
+                *invalid_offset = i;
+            return 2;
+        }
+    }
+    return 0;
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief Para cada mascara de 8 bits, as posicoes dos bits ligados em ordem crescente, um byte
+ * por posicao (byte 0 no byte menos significativo). As posicoes que sobram valem 0x80, que o
+ * pshufb transforma em zero.
+ */
+static const unsigned long long compact_shuffle[256] = {
+    0x8080808080808080ULL, 0x8080808080808000ULL, 0x8080808080808001ULL, 0x8080808080800100ULL,
+    0x8080808080808002ULL, 0x8080808080800200ULL, 0x8080808080800201ULL, 0x8080808080020100ULL,
+    0x8080808080808003ULL, 0x8080808080800300ULL, 0x8080808080800301ULL, 0x8080808080030100ULL,
+    0x8080808080800302ULL, 0x8080808080030200ULL, 0x8080808080030201ULL, 0x8080808003020100ULL,
+    0x8080808080808004ULL, 0x8080808080800400ULL, 0x8080808080800401ULL, 0x8080808080040100ULL,
+    0x8080808080800402ULL, 0x8080808080040200ULL, 0x8080808080040201ULL, 0x8080808004020100ULL,
+    0x8080808080800403ULL, 0x8080808080040300ULL, 0x8080808080040301ULL, 0x8080808004030100ULL,
+    0x8080808080040302ULL, 0x8080808004030200ULL, 0x8080808004030201ULL, 0x8080800403020100ULL,
+    0x8080808080808005ULL, 0x8080808080800500ULL, 0x8080808080800501ULL, 0x8080808080050100ULL,
+    0x8080808080800502ULL, 0x8080808080050200ULL, 0x8080808080050201ULL, 0x8080808005020100ULL,
+    0x8080808080800503ULL, 0x8080808080050300ULL, 0x8080808080050301ULL, 0x8080808005030100ULL,
+    0x8080808080050302ULL, 0x8080808005030200ULL, 0x8080808005030201ULL, 0x8080800503020100ULL,
+    0x8080808080800504ULL, 0x8080808080050400ULL, 0x8080808080050401ULL, 0x8080808005040100ULL,
+    0x8080808080050402ULL, 0x8080808005040200ULL, 0x8080808005040201ULL, 0x8080800504020100ULL,
+    0x8080808080050403ULL, 0x8080808005040300ULL, 0x8080808005040301ULL, 0x8080800504030100ULL,
+    0x8080808005040302ULL, 0x8080800504030200ULL, 0x8080800504030201ULL, 0x8080050403020100ULL,
+    0x8080808080808006ULL, 0x8080808080800600ULL, 0x8080808080800601ULL, 0x8080808080060100ULL,
+    0x8080808080800602ULL, 0x8080808080060200ULL, 0x8080808080060201ULL, 0x8080808006020100ULL,
+    0x8080808080800603ULL, 0x8080808080060300ULL, 0x8080808080060301ULL, 0x8080808006030100ULL,
+    0x8080808080060302ULL, 0x8080808006030200ULL, 0x8080808006030201ULL, 0x8080800603020100ULL,
+    0x8080808080800604ULL, 0x8080808080060400ULL, 0x8080808080060401ULL, 0x8080808006040100ULL,
+    0x8080808080060402ULL, 0x8080808006040200ULL, 0x8080808006040201ULL, 0x8080800604020100ULL,
+    0x8080808080060403ULL, 0x8080808006040300ULL, 0x8080808006040301ULL, 0x8080800604030100ULL,
+    0x8080808006040302ULL, 0x8080800604030200ULL, 0x8080800604030201ULL, 0x8080060403020100ULL,
+    0x8080808080800605ULL, 0x8080808080060500ULL, 0x8080808080060501ULL, 0x8080808006050100ULL,
+    0x8080808080060502ULL, 0x8080808006050200ULL, 0x8080808006050201ULL, 0x8080800605020100ULL,
+    0x8080808080060503ULL, 0x8080808006050300ULL, 0x8080808006050301ULL, 0x8080800605030100ULL,
+    0x8080808006050302ULL, 0x8080800605030200ULL, 0x8080800605030201ULL, 0x8080060503020100ULL,
+    0x8080808080060504ULL, 0x8080808006050400ULL, 0x8080808006050401ULL, 0x8080800605040100ULL,
+    0x8080808006050402ULL, 0x8080800605040200ULL, 0x8080800605040201ULL, 0x8080060504020100ULL,
+    0x8080808006050403ULL, 0x8080800605040300ULL, 0x8080800605040301ULL, 0x8080060504030100ULL,
+    0x8080800605040302ULL, 0x8080060504030200ULL, 0x8080060504030201ULL, 0x8006050403020100ULL,
+    0x8080808080808007ULL, 0x8080808080800700ULL, 0x8080808080800701ULL, 0x8080808080070100ULL,
+    0x8080808080800702ULL, 0x8080808080070200ULL, 0x8080808080070201ULL, 0x8080808007020100ULL,
+    0x8080808080800703ULL, 0x8080808080070300ULL, 0x8080808080070301ULL, 0x8080808007030100ULL,
+    0x8080808080070302ULL, 0x8080808007030200ULL, 0x8080808007030201ULL, 0x8080800703020100ULL,
+    0x8080808080800704ULL, 0x8080808080070400ULL, 0x8080808080070401ULL, 0x8080808007040100ULL,
+    0x8080808080070402ULL, 0x8080808007040200ULL, 0x8080808007040201ULL, 0x8080800704020100ULL,
+    0x8080808080070403ULL, 0x8080808007040300ULL, 0x8080808007040301ULL, 0x8080800704030100ULL,
+    0x8080808007040302ULL, 0x8080800704030200ULL, 0x8080800704030201ULL, 0x8080070403020100ULL,
+    0x8080808080800705ULL, 0x8080808080070500ULL, 0x8080808080070501ULL, 0x8080808007050100ULL,
+    0x8080808080070502ULL, 0x8080808007050200ULL, 0x8080808007050201ULL, 0x8080800705020100ULL,
+    0x8080808080070503ULL, 0x8080808007050300ULL, 0x8080808007050301ULL, 0x8080800705030100ULL,
+    0x8080808007050302ULL, 0x8080800705030200ULL, 0x8080800705030201ULL, 0x8080070503020100ULL,
+    0x8080808080070504ULL, 0x8080808007050400ULL, 0x8080808007050401ULL, 0x8080800705040100ULL,
+    0x8080808007050402ULL, 0x8080800705040200ULL, 0x8080800705040201ULL, 0x8080070504020100ULL,
+    0x8080808007050403ULL, 0x8080800705040300ULL, 0x8080800705040301ULL, 0x8080070504030100ULL,
+    0x8080800705040302ULL, 0x8080070504030200ULL, 0x8080070504030201ULL, 0x8007050403020100ULL,
+    0x8080808080800706ULL, 0x8080808080070600ULL, 0x8080808080070601ULL, 0x8080808007060100ULL,
+    0x8080808080070602ULL, 0x8080808007060200ULL, 0x8080808007060201ULL, 0x8080800706020100ULL,
+    0x8080808080070603ULL, 0x8080808007060300ULL, 0x8080808007060301ULL, 0x8080800706030100ULL,
+    0x8080808007060302ULL, 0x8080800706030200ULL, 0x8080800706030201ULL, 0x8080070603020100ULL,
+    0x8080808080070604ULL, 0x8080808007060400ULL, 0x8080808007060401ULL, 0x8080800706040100ULL,
+    0x8080808007060402ULL, 0x8080800706040200ULL, 0x8080800706040201ULL, 0x8080070604020100ULL,
+    0x8080808007060403ULL, 0x8080800706040300ULL, 0x8080800706040301ULL, 0x8080070604030100ULL,
+    0x8080800706040302ULL, 0x8080070604030200ULL, 0x8080070604030201ULL, 0x8007060403020100ULL,
+    0x8080808080070605ULL, 0x8080808007060500ULL, 0x8080808007060501ULL, 0x8080800706050100ULL,
+    0x8080808007060502ULL, 0x8080800706050200ULL, 0x8080800706050201ULL, 0x8080070605020100ULL,
+    0x8080808007060503ULL, 0x8080800706050300ULL, 0x8080800706050301ULL, 0x8080070605030100ULL,
+    0x8080800706050302ULL, 0x8080070605030200ULL, 0x8080070605030201ULL, 0x8007060503020100ULL,
+    0x8080808007060504ULL, 0x8080800706050400ULL, 0x8080800706050401ULL, 0x8080070605040100ULL,
+    0x8080800706050402ULL, 0x8080070605040200ULL, 0x8080070605040201ULL, 0x8007060504020100ULL,
+    0x8080800706050403ULL, 0x8080070605040300ULL, 0x8080070605040301ULL, 0x8007060504030100ULL,
+    0x8080070605040302ULL, 0x8007060504030200ULL, 0x8007060504030201ULL, 0x0706050403020100ULL
+};
+
+/**
+ * @brief Numero de bits ligados em uma mascara de 8 bits, sem desvios.
+ * (Funcao auxiliar estatica)
+ */
+static int count_bits8(unsigned int mask)
+{
+    mask = mask - ((mask >> 1) & 0x55u);
+    mask = (mask & 0x33u) + ((mask >> 2) & 0x33u);
+    return (int)((mask + (mask >> 4)) & 0x0Fu);
+}
+
+/**
+ * @brief Compacta um bloco de 16 bytes mantendo os bytes indicados em keep_mask: cada metade
+ * de 8 bytes e reordenada pela tabela compact_shuffle e gravada com uma escrita de 8 bytes.
+ * Versao SSE2: as 8 posicoes de cada metade sao copiadas sem desvios, a partir de uma copia
+ * do bloco (o que mantem seguro o uso com output igual a input).
+ * (Funcao auxiliar estatica)
+ *
+ * @return long Numero de bytes mantidos; output recebe ate 16 bytes.
+ */
+static long compact_block_sse2(__m128i block, int keep_mask, char *output)
+{
+    char bytes[16];
+    _mm_storeu_si128((__m128i *)bytes, block);
+
+    long n = 0;
+    for (int half = 0; half < 2; half++)
+    {
+        unsigned int mask = (unsigned int)(keep_mask >> (8 * half)) & 0xFFu;
+        unsigned long long shuffle = compact_shuffle[mask];
+        const char *source = bytes + 8 * half;
+        for (int k = 0; k < 8; k++)
+            output[n + k] = source[(shuffle >> (8 * k)) & 0x7u];
+        n += count_bits8(mask);
+    }
+    return n;
+}
+
+#if defined(ADFGVX_FORMAT_SSSE3)
+/**
+ * @brief Mesma compactacao de compact_block_sse2(), com um unico pshufb para as duas metades.
+ * (Funcao auxiliar estatica)
+ */
+#if !defined(__SSSE3__)
+__attribute__((target("ssse3")))
+#endif
+static long compact_block_ssse3(__m128i block, int keep_mask, char *output)
+{
+    unsigned int low = (unsigned int)keep_mask & 0xFFu;
+    unsigned int high = ((unsigned int)keep_mask >> 8) & 0xFFu;
+    // Os indices da metade alta sao deslocados em 8 (0x80 + 8 continua com o bit alto ligado).
+    __m128i shuffle = _mm_set_epi64x((long long)(compact_shuffle[high] + 0x0808080808080808ULL),
+                                     (long long)compact_shuffle[low]);
+    __m128i packed = _mm_shuffle_epi8(block, shuffle);
+    long n = count_bits8(low);
+    _mm_storel_epi64((__m128i *)output, packed);
+    _mm_storel_epi64((__m128i *)(output + n), _mm_srli_si128(packed, 8));
+    return n + count_bits8(high);
+}
+#endif
+#endif
+
+int adfgvx_ingest_ciphertext(const char *input, long length, char *output, long *symbol_count,
+                             long *invalid_offset)
+{
+    long i = 0;
+    long n = 0;
+
+    if (invalid_offset != NULL)
+        *invalid_offset = -1;
+
+#if defined(__SSE2__)
+    long (*compact_block)(__m128i, int, char *) = compact_block_sse2;
+#if defined(ADFGVX_FORMAT_SSSE3)
+#if defined(__SSSE3__)
+    compact_block = compact_block_ssse3;
+#else
+    if (__builtin_cpu_supports("ssse3"))
+        compact_block = compact_block_ssse3;
+#endif
+#endif
+
+    // Um comparador por simbolo do alfabeto e por separador; 16 caracteres por iteracao.
+    __m128i symbol_vec[ADFGVX_GRID_SIZE];
+    for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+        symbol_vec[s] = _mm_set1_epi8(adfgvx_grid_symbols[s]);
+    const __m128i space_vec = _mm_set1_epi8(' ');
+    const __m128i newline_vec = _mm_set1_epi8('\n');
+    const __m128i return_vec = _mm_set1_epi8('\r');
+    const __m128i tab_vec = _mm_set1_epi8('\t');
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(input + i));
+        __m128i valid = _mm_setzero_si128();
+        for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+            valid = _mm_or_si128(valid, _mm_cmpeq_epi8(block, symbol_vec[s]));
+        __m128i separator = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space_vec), _mm_cmpeq_epi8(block, newline_vec)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(block, return_vec), _mm_cmpeq_epi8(block, tab_vec)));
+        int valid_mask = _mm_movemask_epi8(valid);
+        int separator_mask = _mm_movemask_epi8(separator);
+
+        if ((valid_mask | separator_mask) != 0xFFFF)
+        {
+            // Caractere invalido ou separador raro (como '\v'): so este bloco passa pelo laco
+            // escalar, e os seguintes voltam ao caminho vetorial.
+            if (ingest_scalar(input, i, i + 16, output, &n, invalid_offset) != 0)
+            {
+                if (symbol_count != NULL)
+                    *symbol_count = n;
+                return 2;
+            }
+        }
+        else if (separator_mask == 0)
+        {
+            // Caso comum em texto linear: 16 simbolos validos copiados de uma vez.
+            _mm_storeu_si128((__m128i *)(output + n), block);
+            n += 16;
+        }
+        else
+        {
+            // Texto em grupos: compacta pela mascara de simbolos validos. Escrever no proprio
+            // input e seguro, pois o bloco ja foi lido e a escrita termina antes de i + 16.
+            n += compact_block(block, valid_mask, output + n);
+        }
+    }
+#endif
+
+    int status = ingest_scalar(input, i, length, output, &n, invalid_offset);
+    if (symbol_count != NULL)
+        *symbol_count = n;
+    return status;
+}
+
+long adfgvx_format_size(long symbol_count, int group_size)
+{
+    if (group_size <= 0)
+        return symbol_count;
+    // Um separador antes de cada grupo, exceto possivelmente o primeiro.
+    return symbol_count + symbol_count / group_size + 1;
+}
+
+long adfgvx_format_ciphertext(const char *symbols, long count, int64_t first_symbol, int group_size,
+                              int groups_per_line, char *output)
+{
+    if (group_size <= 0)
+    {
+        memcpy(output, symbols, count);
+        return count;
+    }
+
+    int64_t position = first_symbol;
+    long i = 0;
+    long n = 0;
+
+    while (i < count)
+    {
+        long in_group = (long)(position % group_size);
+        if (in_group == 0 && position > 0)
+        {
+            int64_t group = position / group_size;
+            output[n++] = (groups_per_line > 0 && group % groups_per_line == 0) ? '\n' : ' ';
+        }
+
+        // Copia o restante do grupo atual de uma vez.
+        long run = group_size - in_group;
+        if (run > count - i)
+            run = count - i;
+        memcpy(output + n, symbols + i, run);
+        n += run;
+        i += run;
+        position += run;
+    }
+    return n;
+}
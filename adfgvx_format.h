@@ -0,0 +1,52 @@
+#ifndef ADFGVX_FORMAT_H
+#define ADFGVX_FORMAT_H
+
+#include <stdint.h> // Para int64_t
+#include "cipher_config.h" // Para ADFGVX_GROUP_SIZE, ADFGVX_GROUPS_PER_LINE
+
+/**
+ * @brief Remove espacos e quebras de linha de um texto cifrado agrupado e valida os simbolos.
+ *
+ * Aceita tanto o texto linear quanto o formato convencional em grupos ("ADFGV XAFDG ...\n").
+ * Os blocos de 16 bytes sem espacos sao validados e copiados de uma vez (SSE2 quando
+ * disponivel); os blocos com separadores sao compactados pela mascara de simbolos validos,
+ * com uma tabela de embaralhamento (pshufb, se o processador tiver SSSE3). So um bloco com
+ * caractere invalido ou separador raro ('\v', '\f') passa pelo laco escalar.
+ * output pode ser o proprio input (a compactacao nunca escreve alem da posicao lida).
+ *
+ * @param input Texto a ser normalizado (nao precisa ser terminado em nulo).
+ * @param length Numero de caracteres em input.
+ * @param output Buffer para os simbolos (length posicoes bastam; nao e terminado em nulo).
+ * @param symbol_count Numero de simbolos escritos em output.
+ * @param invalid_offset Posicao (em input) do primeiro caractere invalido, ou -1 (pode ser NULL).
+ * @return int 0 em caso de sucesso, 2 se houver um caractere que nao e simbolo nem espaco.
+ */
+int adfgvx_ingest_ciphertext(const char *input, long length, char *output, long *symbol_count,
+                             long *invalid_offset);
+
+/**
+ * @brief Tamanho maximo do texto gerado por adfgvx_format_ciphertext() para symbol_count simbolos.
+ */
+long adfgvx_format_size(long symbol_count, int group_size);
+
+/**
+ * @brief Formata simbolos em grupos separados por espaco, com quebra de linha a cada
+ * groups_per_line grupos. Os grupos sao copiados com memcpy, nunca caractere a caractere.
+ *
+ * A formatacao depende apenas da posicao absoluta de cada simbolo, entao um texto longo pode
+ * ser formatado em partes: cada parte informa em first_symbol quantos simbolos vieram antes.
+ * Nenhum separador e escrito depois do ultimo simbolo da parte.
+ *
+ * @param symbols Simbolos a formatar.
+ * @param count Numero de simbolos.
+ * @param first_symbol Posicao absoluta de symbols[0] no texto cifrado (64 bits, para textos
+ * com mais de 2^31 simbolos tambem onde long tem 32 bits).
+ * @param group_size Simbolos por grupo (0 ou negativo: sem agrupamento).
+ * @param groups_per_line Grupos por linha (0 ou negativo: tudo em uma linha).
+ * @param output Buffer de adfgvx_format_size(count, group_size) posicoes (nao e terminado em nulo).
+ * @return long Numero de caracteres escritos em output.
+ */
+long adfgvx_format_ciphertext(const char *symbols, long count, int64_t first_symbol, int group_size,
+                              int groups_per_line, char *output);
+
+#endif // ADFGVX_FORMAT_H
@@ -0,0 +1,34 @@
+#ifndef ADFGVX_GRID_H
+#define ADFGVX_GRID_H
+
+// Matriz e alfabeto de simbolos usados por cipher_adfgvx(), decipher_adfgvx() e pelos demais
+// modulos deste projeto. A variante e escolhida em tempo de compilacao por ADFGVX_GRID_SIZE
+// (cipher_config.h) e gera as funcoes adfgvx_grid_*() a partir de fractionating_kernel.h.
+
+#include "cipher_config.h" // Para ADFGVX_GRID_SIZE
+#include "fractionating_grids.h"
+
+#define FRAC_PREFIX adfgvx_grid
+
+#if ADFGVX_GRID_SIZE == 5
+#define FRAC_GRID_SIZE FRACTIONATING_ADFGX_GRID_SIZE
+#define FRAC_SYMBOLS FRACTIONATING_ADFGX_SYMBOLS
+#define FRAC_CELLS FRACTIONATING_ADFGX_CELLS
+#define FRAC_ALIASES FRACTIONATING_ADFGX_ALIASES
+#elif ADFGVX_GRID_SIZE == 6
+#define FRAC_GRID_SIZE FRACTIONATING_ADFGVX_GRID_SIZE
+#define FRAC_SYMBOLS FRACTIONATING_ADFGVX_SYMBOLS
+#define FRAC_CELLS FRACTIONATING_ADFGVX_CELLS
+#define FRAC_ALIASES FRACTIONATING_ADFGVX_ALIASES
+#elif ADFGVX_GRID_SIZE == 8
+#define FRAC_GRID_SIZE FRACTIONATING_ADFGVX8_GRID_SIZE
+#define FRAC_SYMBOLS FRACTIONATING_ADFGVX8_SYMBOLS
+#define FRAC_CELLS FRACTIONATING_ADFGVX8_CELLS
+#define FRAC_ALIASES FRACTIONATING_ADFGVX8_ALIASES
+#else
+#error "ADFGVX_GRID_SIZE deve ser 5 (ADFGX), 6 (ADFGVX) ou 8 (ADFGVX estendido)"
+#endif
+
+#include "fractionating_kernel.h"
+
+#endif // ADFGVX_GRID_H
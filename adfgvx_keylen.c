@@ -0,0 +1,459 @@
+#define _POSIX_C_SOURCE 200809L // Para clock_gettime
+#include "adfgvx_keylen.h"
+#include "adfgvx_grid.h" // Alfabeto de simbolos (adfgvx_grid_symbol_index)
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Numero de contadores de um histograma: simbolos de posicao par e de posicao impar.
+#define HISTOGRAM_SIZE (2 * ADFGVX_GRID_SIZE)
+
+// Fracao da maior coerencia a partir da qual um candidato e considerado consistente.
+#define CONSISTENT_RATIO 0.5
+
+/**
+ * @brief Dados compartilhados (somente leitura) entre as threads.
+ */
+typedef struct keylen_problem
+{
+    const unsigned char *symbol;  // Indice de cada simbolo do texto no alfabeto.
+    long length;
+    const long *cumulative;       // cumulative[b * HISTOGRAM_SIZE + ...]: contagens antes do simbolo b * ADFGVX_KEYLEN_BLOCK.
+    long symbol_total[ADFGVX_GRID_SIZE];
+    int max_key_length;
+    double *score;                // score[k], escrito apenas pela thread que avalia k.
+    adfgvx_keylen_candidate *refine; // Segunda etapa: candidatos cuja coerencia sera medida.
+    int refine_count;
+} keylen_problem;
+
+/**
+ * @brief Estado de uma thread: avalia os candidatos first, first + step, ...
+ */
+typedef struct keylen_worker
+{
+    const keylen_problem *problem;
+    int first;
+    int step;
+    pthread_t thread;
+} keylen_worker;
+
+/**
+ * @brief Tempo de relogio (em segundos) para medir a duracao com varias threads.
+ * (Funcao auxiliar estatica)
+ */
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Soma ao histograma os simbolos das posicoes [begin, end), separando por paridade.
+ * Quatro histogramas parciais (dois por paridade) evitam que incrementos consecutivos do
+ * mesmo contador fiquem em serie.
+ * (Funcao auxiliar estatica)
+ */
+static void count_symbols(const unsigned char *symbol, long begin, long end, long histogram[HISTOGRAM_SIZE])
+{
+    long lane[4][ADFGVX_GRID_SIZE] = {{0}};
+    long i = begin;
+
+    if (i < end && (i & 1))
+    {
+        histogram[ADFGVX_GRID_SIZE + symbol[i]]++;
+        i++;
+    }
+    for (; i + 4 <= end; i += 4)
+    {
+        lane[0][symbol[i]]++;
+        lane[1][symbol[i + 1]]++;
+        lane[2][symbol[i + 2]]++;
+        lane[3][symbol[i + 3]]++;
+    }
+    for (; i < end; i++)
+        histogram[(i & 1) * ADFGVX_GRID_SIZE + symbol[i]]++;
+
+    for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+    {
+        histogram[s] += lane[0][s] + lane[2][s];
+        histogram[ADFGVX_GRID_SIZE + s] += lane[1][s] + lane[3][s];
+    }
+}
+
+/**
+ * @brief Histograma (por paridade) do trecho [begin, end), usando os histogramas acumulados.
+ * (Funcao auxiliar estatica)
+ */
+static void range_histogram(const keylen_problem *problem, long begin, long end, long histogram[HISTOGRAM_SIZE])
+{
+    long first_block = (begin + ADFGVX_KEYLEN_BLOCK - 1) / ADFGVX_KEYLEN_BLOCK;
+    long last_block = end / ADFGVX_KEYLEN_BLOCK;
+
+    memset(histogram, 0, HISTOGRAM_SIZE * sizeof(long));
+    if (first_block >= last_block)
+    {
+        count_symbols(problem->symbol, begin, end, histogram);
+        return;
+    }
+
+    const long *from = problem->cumulative + first_block * HISTOGRAM_SIZE;
+    const long *to = problem->cumulative + last_block * HISTOGRAM_SIZE;
+    for (int h = 0; h < HISTOGRAM_SIZE; h++)
+        histogram[h] = to[h] - from[h];
+    count_symbols(problem->symbol, begin, first_block * ADFGVX_KEYLEN_BLOCK, histogram);
+    count_symbols(problem->symbol, last_block * ADFGVX_KEYLEN_BLOCK, end, histogram);
+}
+
+/**
+ * @brief Pontua um comprimento candidato: qui-quadrado entre as 2k amostras menos 2 vezes os
+ * graus de liberdade, por simbolo do texto.
+ * (Funcao auxiliar estatica)
+ */
+static double score_key_length(const keylen_problem *problem, int key_length)
+{
+    long histogram[HISTOGRAM_SIZE];
+    double weighted = 0.0; // Soma de O^2 / (n_amostra * total_simbolo).
+    int samples = 0;
+    int symbols = 0;
+
+    for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+        symbols += problem->symbol_total[s] > 0;
+
+    for (int j = 0; j < key_length; j++)
+    {
+        long begin = (long)((double)problem->length * j / key_length);
+        long end = (long)((double)problem->length * (j + 1) / key_length);
+        range_histogram(problem, begin, end, histogram);
+
+        for (int parity = 0; parity < 2; parity++)
+        {
+            const long *observed = histogram + parity * ADFGVX_GRID_SIZE;
+            long sample_size = 0;
+            for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+                sample_size += observed[s];
+            if (sample_size == 0)
+                continue;
+
+            samples++;
+            for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+            {
+                if (problem->symbol_total[s] > 0)
+                    weighted += (double)observed[s] * observed[s] / ((double)sample_size * problem->symbol_total[s]);
+            }
+        }
+    }
+
+    double chi_square = problem->length * weighted - problem->length;
+    double degrees = (double)(samples - 1) * (symbols - 1);
+    return (chi_square - 2.0 * degrees) / problem->length;
+}
+
+/**
+ * @brief Funcao executada por cada thread.
+ * (Funcao auxiliar estatica)
+ */
+static void *keylen_worker_run(void *arg)
+{
+    keylen_worker *worker = arg;
+    const keylen_problem *problem = worker->problem;
+
+    for (int k = worker->first; k <= problem->max_key_length; k += worker->step)
+        problem->score[k] = score_key_length(problem, k);
+    return NULL;
+}
+
+/**
+ * @brief Coerencia entre pares de trechos: na mensagem intermediaria, o simbolo de linha e o de
+ * coluna de um mesmo caractere ficam na mesma linha de colunas vizinhas (ou na linha seguinte,
+ * da ultima coluna para a primeira). Para cada trecho, procura o trecho parceiro e o pequeno
+ * deslocamento em que os pares de simbolos alinhados sao mais dependentes (qui-quadrado de
+ * independencia, descontado o maximo esperado ao acaso), e retorna a media dessa dependencia.
+ * (Funcao auxiliar estatica)
+ *
+ * O trecho j comeca em j * rows mais o numero de colunas longas antes dele, que cresce com j:
+ * o deslocamento entre os trechos a e b fica entre 0 e |b - a| (limitado a extra), no sentido
+ * de b - a, mais uma linha quando o par passa da ultima coluna para a primeira.
+ */
+static double pair_coherence(const keylen_problem *problem, int key_length)
+{
+    if (key_length > ADFGVX_KEYLEN_PAIR_MAX_KEY)
+        return 0.0;
+
+    long rows = problem->length / key_length;
+    int max_shift = (int)(problem->length % key_length);
+    if (max_shift > ADFGVX_KEYLEN_MAX_SHIFT)
+        max_shift = ADFGVX_KEYLEN_MAX_SHIFT;
+
+    // Linhas amostradas no meio de cada trecho, com folga para os deslocamentos.
+    long sample_rows = rows - 2 * max_shift - 2;
+    if (sample_rows > ADFGVX_KEYLEN_PAIR_ROWS)
+        sample_rows = ADFGVX_KEYLEN_PAIR_ROWS;
+    if (sample_rows < 2 * ADFGVX_GRID_SIZE * ADFGVX_GRID_SIZE)
+        return 0.0; // Poucas linhas para medir dependencia entre pares.
+    long first_row = (rows - sample_rows) / 2;
+
+    double degrees = (ADFGVX_GRID_SIZE - 1) * (ADFGVX_GRID_SIZE - 1);
+    // Desconto de 2 * graus de liberdade, como na primeira etapa: cobre o maximo do
+    // qui-quadrado ao acaso entre as tentativas de um trecho.
+    double noise = 2.0 * degrees;
+    double total = 0.0;
+
+    for (int a = 0; a < key_length; a++)
+    {
+        const unsigned char *row_symbol = problem->symbol + a * rows + first_row;
+        double best = 0.0;
+
+        for (int b = 0; b < key_length; b++)
+        {
+            int distance = b > a ? b - a : a - b;
+            int reach = distance < max_shift ? distance : max_shift;
+            int lowest = b < a ? -reach : 0;
+            int highest = (b > a ? reach : 0) + 1;
+
+            for (int shift = lowest; shift <= highest; shift++)
+            {
+                if (a == b && shift == 0)
+                    continue;
+
+                const unsigned char *col_symbol = problem->symbol + b * rows + first_row + shift;
+                long pairs[ADFGVX_GRID_SIZE][ADFGVX_GRID_SIZE] = {{0}};
+                long row_count[ADFGVX_GRID_SIZE] = {0};
+                long col_count[ADFGVX_GRID_SIZE] = {0};
+                for (long t = 0; t < sample_rows; t++)
+                {
+                    pairs[row_symbol[t]][col_symbol[t]]++;
+                    row_count[row_symbol[t]]++;
+                    col_count[col_symbol[t]]++;
+                }
+
+                double weighted = 0.0;
+                for (int r = 0; r < ADFGVX_GRID_SIZE; r++)
+                {
+                    for (int c = 0; c < ADFGVX_GRID_SIZE; c++)
+                    {
+                        if (pairs[r][c] > 0)
+                            weighted += (double)pairs[r][c] * pairs[r][c] / ((double)row_count[r] * col_count[c]);
+                    }
+                }
+                double excess = (sample_rows * weighted - sample_rows - noise) / sample_rows;
+                if (excess > best)
+                    best = excess;
+            }
+        }
+        total += best;
+    }
+    return total / key_length;
+}
+
+/**
+ * @brief Funcao executada por cada thread na segunda etapa (coerencia dos melhores candidatos).
+ * (Funcao auxiliar estatica)
+ */
+static void *coherence_worker_run(void *arg)
+{
+    keylen_worker *worker = arg;
+    const keylen_problem *problem = worker->problem;
+
+    for (int i = worker->first; i < problem->refine_count; i += worker->step)
+    {
+        adfgvx_keylen_candidate *candidate = &problem->refine[i];
+        candidate->coherence = pair_coherence(problem, candidate->key_length);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Compara candidatos por pontuacao decrescente (empate: menor comprimento primeiro).
+ * (Funcao auxiliar estatica)
+ */
+static int compare_candidates(const void *a, const void *b)
+{
+    const adfgvx_keylen_candidate *x = a;
+    const adfgvx_keylen_candidate *y = b;
+
+    if (x->score != y->score)
+        return x->score < y->score ? 1 : -1;
+    return x->key_length - y->key_length;
+}
+
+/**
+ * @brief Executa routine em thread_count threads; a thread t recebe first = first_base + t.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se alguma thread nao puder ser criada.
+ */
+static int run_workers(const keylen_problem *problem, keylen_worker *workers, int thread_count, int first_base,
+                       void *(*routine)(void *))
+{
+    int status = 0;
+    int started = 0;
+
+    for (; started < thread_count; started++)
+    {
+        workers[started].problem = problem;
+        workers[started].first = first_base + started;
+        workers[started].step = thread_count;
+        if (pthread_create(&workers[started].thread, NULL, routine, &workers[started]) != 0)
+        {
+            status = 1;
+            break;
+        }
+    }
+    for (int t = 0; t < started; t++)
+        pthread_join(workers[t].thread, NULL);
+    return status;
+}
+
+/**
+ * @brief Reordena o relatorio: primeiro os candidatos consistentes (coerencia de pelo menos
+ * CONSISTENT_RATIO da maior), do menor para o maior comprimento, ja que os multiplos do
+ * comprimento certo tambem sao consistentes; depois os demais, por coerencia decrescente.
+ * (Funcao auxiliar estatica)
+ */
+static void rank_by_coherence(adfgvx_keylen_report *report)
+{
+    double best = 0.0;
+    for (int i = 0; i < report->candidate_count; i++)
+    {
+        if (report->candidates[i].coherence > best)
+            best = report->candidates[i].coherence;
+    }
+    if (best <= 0.0)
+        return; // Texto curto demais para a segunda etapa: mantem a ordem da primeira.
+
+    double threshold = CONSISTENT_RATIO * best;
+    for (int i = 1; i < report->candidate_count; i++)
+    {
+        adfgvx_keylen_candidate candidate = report->candidates[i];
+        int consistent = candidate.coherence >= threshold;
+        int pos = i;
+
+        while (pos > 0)
+        {
+            const adfgvx_keylen_candidate *previous = &report->candidates[pos - 1];
+            int previous_consistent = previous->coherence >= threshold;
+            int stays = consistent ? (previous_consistent && previous->key_length < candidate.key_length)
+                                   : (previous_consistent || previous->coherence >= candidate.coherence);
+            if (stays)
+                break;
+            report->candidates[pos] = *previous;
+            pos--;
+        }
+        report->candidates[pos] = candidate;
+    }
+}
+
+/**
+ * @brief Prepara os histogramas acumulados, avalia os candidatos nas threads e preenche o relatorio.
+ * (Funcao auxiliar estatica)
+ *
+ * @param problem Problema com length, max_key_length e os buffers symbol, cumulative e score alocados.
+ * @return int 0 em caso de sucesso, 1 se nao for possivel criar as threads, 2 se simbolo invalido.
+ */
+static int run_estimate(keylen_problem *problem, const char *ciphertext, unsigned char *symbol, long *cumulative,
+                        keylen_worker *workers, int thread_count, adfgvx_keylen_report *report)
+{
+    long length = problem->length;
+    long block_count = length / ADFGVX_KEYLEN_BLOCK + 1;
+
+    // Unica passada sobre o texto: indices dos simbolos e histogramas acumulados por bloco.
+    for (long i = 0; i < length; i++)
+    {
+        int index = adfgvx_grid_symbol_index(ciphertext[i]);
+        if (index < 0)
+            return 2;
+        symbol[i] = (unsigned char)index;
+    }
+
+    memset(cumulative, 0, HISTOGRAM_SIZE * sizeof(long));
+    for (long b = 1; b < block_count; b++)
+    {
+        long *histogram = cumulative + b * HISTOGRAM_SIZE;
+        memcpy(histogram, histogram - HISTOGRAM_SIZE, HISTOGRAM_SIZE * sizeof(long));
+        count_symbols(symbol, (b - 1) * ADFGVX_KEYLEN_BLOCK, b * ADFGVX_KEYLEN_BLOCK, histogram);
+    }
+
+    long total[HISTOGRAM_SIZE];
+    memcpy(total, cumulative + (block_count - 1) * HISTOGRAM_SIZE, sizeof(total));
+    count_symbols(symbol, (block_count - 1) * ADFGVX_KEYLEN_BLOCK, length, total);
+    for (int s = 0; s < ADFGVX_GRID_SIZE; s++)
+        problem->symbol_total[s] = total[s] + total[ADFGVX_GRID_SIZE + s];
+    problem->symbol = symbol;
+    problem->cumulative = cumulative;
+
+    if (run_workers(problem, workers, thread_count, 1, keylen_worker_run) != 0)
+        return 1;
+
+    // Mantem os ADFGVX_KEYLEN_MAX_RESULTS melhores, em ordem.
+    for (int k = 1; k <= problem->max_key_length; k++)
+    {
+        adfgvx_keylen_candidate candidate = {k, problem->score[k], 0.0};
+        int count = report->candidate_count;
+
+        if (count == ADFGVX_KEYLEN_MAX_RESULTS)
+        {
+            if (compare_candidates(&candidate, &report->candidates[count - 1]) >= 0)
+                continue;
+            count--;
+        }
+        int pos = count;
+        while (pos > 0 && compare_candidates(&candidate, &report->candidates[pos - 1]) < 0)
+        {
+            report->candidates[pos] = report->candidates[pos - 1];
+            pos--;
+        }
+        report->candidates[pos] = candidate;
+        report->candidate_count = count + 1;
+    }
+    report->evaluated = problem->max_key_length;
+
+    // Segunda etapa: coerencia entre pares apenas dos candidatos guardados.
+    problem->refine = report->candidates;
+    problem->refine_count = report->candidate_count;
+    if (run_workers(problem, workers, thread_count, 0, coherence_worker_run) != 0)
+        return 1;
+    rank_by_coherence(report);
+    return 0;
+}
+
+int adfgvx_estimate_key_length(const char *ciphertext, long length, int max_key_length,
+                               int thread_count, adfgvx_keylen_report *report)
+{
+    keylen_problem problem;
+    int status = 1;
+
+    if (ciphertext == NULL || report == NULL || length < 2 || max_key_length <= 0 || thread_count <= 0)
+        return 2;
+
+    memset(report, 0, sizeof(*report));
+    if (max_key_length > ADFGVX_KEYLEN_MAX_CANDIDATE)
+        max_key_length = ADFGVX_KEYLEN_MAX_CANDIDATE;
+    if (max_key_length > length / 2)
+        max_key_length = (int)(length / 2);
+    if (thread_count > max_key_length)
+        thread_count = max_key_length;
+
+    double start_time = wall_seconds();
+    unsigned char *symbol = malloc((size_t)length);
+    long *cumulative = malloc(((size_t)length / ADFGVX_KEYLEN_BLOCK + 1) * HISTOGRAM_SIZE * sizeof(long));
+    double *score = malloc(((size_t)max_key_length + 1) * sizeof(double));
+    keylen_worker *workers = calloc((size_t)thread_count, sizeof(keylen_worker));
+
+    if (symbol != NULL && cumulative != NULL && score != NULL && workers != NULL)
+    {
+        memset(&problem, 0, sizeof(problem));
+        problem.length = length;
+        problem.max_key_length = max_key_length;
+        problem.score = score;
+        status = run_estimate(&problem, ciphertext, symbol, cumulative, workers, thread_count, report);
+    }
+
+    report->elapsed_seconds = wall_seconds() - start_time;
+    free(symbol);
+    free(cumulative);
+    free(score);
+    free(workers);
+    return status;
+}
@@ -0,0 +1,81 @@
+#ifndef ADFGVX_KEYLEN_H
+#define ADFGVX_KEYLEN_H
+
+#include "cipher_config.h" // Para ADFGVX_GRID_SIZE
+
+// Numero padrao de threads usadas para avaliar os comprimentos candidatos.
+#define ADFGVX_KEYLEN_THREADS 4
+
+// Maior comprimento de chave que pode ser avaliado.
+#define ADFGVX_KEYLEN_MAX_CANDIDATE 1024
+
+// Numero de candidatos guardados no relatorio (os de maior pontuacao).
+#define ADFGVX_KEYLEN_MAX_RESULTS 16
+
+// Intervalo (em simbolos) entre os histogramas acumulados usados para somar trechos.
+#define ADFGVX_KEYLEN_BLOCK 64
+
+// Segunda etapa: linhas amostradas por par de trechos, maior deslocamento entre inicios de
+// colunas testado e maior comprimento cuja coerencia e medida (o custo cresce com k^2).
+#define ADFGVX_KEYLEN_PAIR_ROWS 512
+#define ADFGVX_KEYLEN_MAX_SHIFT 8
+#define ADFGVX_KEYLEN_PAIR_MAX_KEY 64
+
+/**
+ * @brief Pontuacao de um comprimento de chave candidato.
+ */
+typedef struct adfgvx_keylen_candidate
+{
+    int key_length;
+    double score;     // Excesso de heterogeneidade por simbolo; maior e mais provavel.
+    double coherence; // Dependencia media entre pares de trechos (0 se nao medida).
+} adfgvx_keylen_candidate;
+
+/**
+ * @brief Candidatos ordenados por pontuacao e metricas da estimativa.
+ */
+typedef struct adfgvx_keylen_report
+{
+    adfgvx_keylen_candidate candidates[ADFGVX_KEYLEN_MAX_RESULTS]; // Do mais para o menos provavel.
+    int candidate_count;      // Candidatos guardados em candidates.
+    int evaluated;            // Comprimentos avaliados (1 a max_key_length).
+    double elapsed_seconds;
+} adfgvx_keylen_report;
+
+/**
+ * @brief Estima o comprimento da chave a partir apenas do texto cifrado.
+ *
+ * Na mensagem intermediaria os simbolos de posicao par indicam a linha da matriz e os de
+ * posicao impar a coluna, e as duas distribuicoes sao diferentes. A coluna c da transposicao
+ * guarda as posicoes c, c + k, c + 2k, ...: com k par ela so tem simbolos de um tipo; com k
+ * impar os tipos se alternam, com fase fixa dentro da coluna. Para cada candidato k o texto e
+ * dividido em k trechos de mesmo tamanho, e cada trecho em simbolos de posicao par e impar.
+ * No comprimento certo essas 2k amostras sao puras e a heterogeneidade entre elas (qui-quadrado)
+ * e maxima; em comprimentos errados os trechos cruzam fronteiras de colunas e misturam os tipos.
+ * A pontuacao desconta o numero de graus de liberdade, o que favorece k em relacao aos
+ * seus multiplos (que tambem geram amostras puras).
+ *
+ * Quando as colunas tem todas a mesma fase, divisores de k tambem geram amostras puras. Por
+ * isso os ADFGVX_KEYLEN_MAX_RESULTS melhores passam por uma segunda etapa: no comprimento
+ * certo cada trecho tem um parceiro cujos simbolos, linha a linha, completam os pares da
+ * mensagem intermediaria, e essa dependencia entre pares desaparece nos divisores. Os
+ * candidatos consistentes (coerencia de pelo menos metade da maior) vem primeiro, do menor
+ * para o maior: os multiplos de k tambem sao consistentes e ficam logo depois de k. Uma chave
+ * cuja ordem torna k equivalente a um divisor nao pode ser distinguida desse divisor.
+ *
+ * Os histogramas de cada trecho sao obtidos de histogramas acumulados a cada
+ * ADFGVX_KEYLEN_BLOCK simbolos, calculados em uma unica passada; cada candidato custa O(k).
+ * As duas etapas distribuem os candidatos entre threads.
+ *
+ * @param ciphertext Texto cifrado linearizado (apenas simbolos; ver adfgvx_ingest_ciphertext()).
+ * @param length Numero de simbolos em ciphertext.
+ * @param max_key_length Maior comprimento a avaliar (limitado a ADFGVX_KEYLEN_MAX_CANDIDATE e a length / 2).
+ * @param thread_count Numero de threads (use ADFGVX_KEYLEN_THREADS na duvida).
+ * @param report Relatorio a ser preenchido.
+ * @return int 0 em caso de sucesso, 1 se faltar memoria ou nao for possivel criar as threads,
+ * 2 se parametros invalidos ou simbolo fora do alfabeto.
+ */
+int adfgvx_estimate_key_length(const char *ciphertext, long length, int max_key_length,
+                               int thread_count, adfgvx_keylen_report *report);
+
+#endif // ADFGVX_KEYLEN_H
@@ -0,0 +1,450 @@
+#define _POSIX_C_SOURCE 200809L // Para clock_gettime
+#include "adfgvx_pipeline.h"
+#include "adfgvx_column_store.h" // Para adfgvx_store_encode_chunk
+#include "adfgvx_core.h"         // Para adfgvx_key_order
+#include "adfgvx_format.h"       // Para adfgvx_format_ciphertext
+#include "adfgvx_grid.h"         // Para adfgvx_grid_cell
+#include "file_operations.h"     // Para file_seek_64
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Posicao de um buffer circular: um trecho de texto ou de simbolos agrupados.
+ */
+typedef struct pipeline_slot
+{
+    char *data;
+    long length;                        // Caracteres (entrada) ou simbolos (saida) em data.
+    int64_t first_symbol;               // Apenas na saida: simbolos gerados pelos trechos anteriores.
+    long column_fill[MAX_KEY_LENGTH];   // Apenas na saida: simbolos de cada coluna em data.
+    int end;                            // Marca de fim de fluxo (nenhum dado).
+} pipeline_slot;
+
+/**
+ * @brief Buffer circular de tamanho fixo entre duas etapas.
+ * O produtor preenche slots[head]; o consumidor processa slots[tail] e so depois o libera.
+ */
+typedef struct pipeline_ring
+{
+    pipeline_slot slots[ADFGVX_PIPELINE_SLOTS];
+    int head, tail, count;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} pipeline_ring;
+
+/**
+ * @brief Estado compartilhado pelas tres etapas.
+ */
+typedef struct pipeline_context
+{
+    FILE *input;
+    FILE *output;
+    int key_length;
+    int group_size;
+    int groups_per_line;
+    int64_t column_start[MAX_KEY_LENGTH]; // Inicio de cada coluna original no texto cifrado linear.
+    char *formatted;                      // Buffer da thread de escrita para um grupo formatado.
+    pipeline_ring to_compute;
+    pipeline_ring to_write;
+    int read_status;
+    int write_status;
+    adfgvx_pipeline_stats stats;
+} pipeline_context;
+
+/**
+ * @brief Tempo de relogio (em segundos).
+ * (Funcao auxiliar estatica)
+ */
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Posicao, no arquivo formatado, do simbolo de posicao `symbol` do texto cifrado linear.
+ * Cada grupo completo anterior ao simbolo contribui com um separador.
+ * (Funcao auxiliar estatica)
+ */
+static int64_t formatted_offset(int64_t symbol, int group_size)
+{
+    return group_size > 0 ? symbol + symbol / group_size : symbol;
+}
+
+/**
+ * @brief Passada inicial: conta os simbolos que o arquivo inteiro vai gerar e volta ao inicio.
+ * (Funcao auxiliar estatica)
+ *
+ * @param buffer Buffer de ADFGVX_PIPELINE_CHUNK posicoes.
+ * @return int 0 em caso de sucesso, 1 se erro de leitura.
+ */
+static int count_symbols(FILE *input, char *buffer, int64_t *symbol_count)
+{
+    int64_t valid = 0;
+    size_t n;
+
+    while ((n = fread(buffer, 1, ADFGVX_PIPELINE_CHUNK, input)) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+            valid += adfgvx_grid_cell(buffer[i]) >= 0;
+    }
+    if (ferror(input) || file_seek_64(input, 0, SEEK_SET) != 0)
+        return 1;
+
+    *symbol_count = 2 * valid;
+    return 0;
+}
+
+/**
+ * @brief Calcula o inicio de cada coluna original no texto cifrado linear, com as colunas na
+ * ordem alfabetica (estavel) da chave dada por adfgvx_key_order().
+ * (Funcao auxiliar estatica)
+ */
+static void compute_column_starts(const char *key, int key_length, int64_t symbol_count, int64_t column_start[])
+{
+    int order[MAX_KEY_LENGTH];
+
+    adfgvx_key_order(key, key_length, order);
+
+    int64_t pos = 0;
+    for (int i = 0; i < key_length; i++)
+    {
+        int c = order[i];
+        column_start[c] = pos;
+        pos += symbol_count / key_length + (c < symbol_count % key_length ? 1 : 0);
+    }
+}
+
+/**
+ * @brief Inicializa um buffer circular e aloca os dados de cada posicao.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se faltar memoria.
+ */
+static int ring_init(pipeline_ring *ring, long slot_size)
+{
+    memset(ring, 0, sizeof(*ring));
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->not_empty, NULL);
+    pthread_cond_init(&ring->not_full, NULL);
+    for (int i = 0; i < ADFGVX_PIPELINE_SLOTS; i++)
+    {
+        ring->slots[i].data = malloc((size_t)slot_size);
+        if (ring->slots[i].data == NULL)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Libera os dados e os objetos de sincronizacao de um buffer circular.
+ * (Funcao auxiliar estatica)
+ */
+static void ring_destroy(pipeline_ring *ring)
+{
+    for (int i = 0; i < ADFGVX_PIPELINE_SLOTS; i++)
+        free(ring->slots[i].data);
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->not_empty);
+    pthread_cond_destroy(&ring->not_full);
+}
+
+/**
+ * @brief Produtor: espera uma posicao livre e a retorna para preenchimento.
+ * (Funcao auxiliar estatica)
+ */
+static pipeline_slot *ring_acquire_free(pipeline_ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == ADFGVX_PIPELINE_SLOTS)
+        pthread_cond_wait(&ring->not_full, &ring->lock);
+    pipeline_slot *slot = &ring->slots[ring->head];
+    pthread_mutex_unlock(&ring->lock);
+    return slot;
+}
+
+/**
+ * @brief Produtor: entrega a posicao preenchida ao consumidor.
+ * (Funcao auxiliar estatica)
+ */
+static void ring_publish(pipeline_ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->head = (ring->head + 1) % ADFGVX_PIPELINE_SLOTS;
+    ring->count++;
+    pthread_cond_signal(&ring->not_empty);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/**
+ * @brief Consumidor: espera a proxima posicao preenchida.
+ * (Funcao auxiliar estatica)
+ */
+static pipeline_slot *ring_acquire(pipeline_ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == 0)
+        pthread_cond_wait(&ring->not_empty, &ring->lock);
+    pipeline_slot *slot = &ring->slots[ring->tail];
+    pthread_mutex_unlock(&ring->lock);
+    return slot;
+}
+
+/**
+ * @brief Consumidor: devolve a posicao processada ao produtor.
+ * (Funcao auxiliar estatica)
+ */
+static void ring_release(pipeline_ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->tail = (ring->tail + 1) % ADFGVX_PIPELINE_SLOTS;
+    ring->count--;
+    pthread_cond_signal(&ring->not_full);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/**
+ * @brief Thread de leitura: le trechos do arquivo de entrada ate o fim.
+ * (Funcao auxiliar estatica)
+ */
+static void *reader_run(void *arg)
+{
+    pipeline_context *ctx = (pipeline_context *)arg;
+
+    for (;;)
+    {
+        pipeline_slot *slot = ring_acquire_free(&ctx->to_compute);
+
+        double start_time = wall_seconds();
+        size_t n = fread(slot->data, 1, ADFGVX_PIPELINE_CHUNK, ctx->input);
+        ctx->stats.read_seconds += wall_seconds() - start_time;
+
+        if (n == 0 && ferror(ctx->input))
+            ctx->read_status = 1;
+        slot->length = (long)n;
+        slot->end = n == 0;
+        ctx->stats.bytes_read += (long)n;
+        ring_publish(&ctx->to_compute);
+
+        if (slot->end)
+            return NULL;
+    }
+}
+
+/**
+ * @brief Formata os simbolos de cada coluna de um trecho e os grava na posicao final.
+ * Os simbolos da coluna c neste trecho continuam a coluna logo apos as linhas gravadas pelos
+ * trechos anteriores, entao a posicao e conhecida sem esperar o fim da entrada.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de escrita.
+ */
+static int write_chunk(pipeline_context *ctx, const pipeline_slot *slot)
+{
+    int key_length = ctx->key_length;
+    long pos = 0;
+
+    for (int c = 0; c < key_length; c++)
+    {
+        long count = slot->column_fill[c];
+        if (count == 0)
+            continue;
+
+        // Linhas da coluna c geradas antes deste trecho (simbolos n < first_symbol com n % k == c).
+        int64_t rows_before = slot->first_symbol / key_length + (c < slot->first_symbol % key_length ? 1 : 0);
+        int64_t first = ctx->column_start[c] + rows_before;
+        long length = adfgvx_format_ciphertext(slot->data + pos, count, first, ctx->group_size,
+                                               ctx->groups_per_line, ctx->formatted);
+
+        // Se a parte comeca em um novo grupo, o separador que a precede tambem e escrito.
+        int64_t offset = formatted_offset(first, ctx->group_size);
+        if (ctx->group_size > 0 && first > 0 && first % ctx->group_size == 0)
+            offset--;
+
+        if (file_seek_64(ctx->output, offset, SEEK_SET) != 0 ||
+            fwrite(ctx->formatted, 1, (size_t)length, ctx->output) != (size_t)length)
+        {
+            perror("Erro ao escrever no arquivo de saida cifrada");
+            return 1;
+        }
+        pos += count;
+    }
+    return 0;
+}
+
+/**
+ * @brief Thread de escrita: grava cada trecho agrupado diretamente no arquivo cifrado.
+ * Depois de um erro continua consumindo (sem gravar) para nao travar o calculo.
+ * (Funcao auxiliar estatica)
+ */
+static void *writer_run(void *arg)
+{
+    pipeline_context *ctx = (pipeline_context *)arg;
+
+    for (;;)
+    {
+        pipeline_slot *slot = ring_acquire(&ctx->to_write);
+        int end = slot->end;
+
+        if (!end && ctx->write_status == 0)
+        {
+            double start_time = wall_seconds();
+            ctx->write_status = write_chunk(ctx, slot);
+            ctx->stats.write_seconds += wall_seconds() - start_time;
+            ctx->stats.symbols_written += slot->length;
+        }
+        ring_release(&ctx->to_write);
+
+        if (end)
+            return NULL;
+    }
+}
+
+int adfgvx_pipeline_encrypt_file(const char *message_filename,
+                                 const char *key,
+                                 int key_length,
+                                 const char *encrypted_filename,
+                                 int group_size,
+                                 int groups_per_line,
+                                 adfgvx_pipeline_stats *stats)
+{
+    pipeline_context *ctx;
+    pthread_t reader, writer;
+    int64_t total_symbols = 0;
+    int64_t next_symbol = 0;
+    int status = 0;
+
+    if (message_filename == NULL || key == NULL || encrypted_filename == NULL ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH || (int)strlen(key) != key_length)
+    {
+        return 2;
+    }
+
+    // O contexto contem os buffers circulares; fica no heap para nao pesar na pilha.
+    ctx = calloc(1, sizeof(pipeline_context));
+    if (ctx == NULL)
+        return 1;
+    ctx->key_length = key_length;
+    ctx->group_size = group_size;
+    ctx->groups_per_line = groups_per_line;
+
+    double start_time = wall_seconds();
+
+    ctx->input = fopen(message_filename, "rb");
+    if (ctx->input == NULL)
+    {
+        free(ctx);
+        return 1;
+    }
+    // Binario: as posicoes calculadas contam um byte por quebra de linha.
+    ctx->output = fopen(encrypted_filename, "wb");
+    if (ctx->output == NULL)
+    {
+        perror("Erro ao abrir arquivo para escrita da saida cifrada");
+        fclose(ctx->input);
+        free(ctx);
+        return 1;
+    }
+
+    // Os dois buffers sao sempre inicializados, para que ring_destroy() seja seguro.
+    int ring_status = ring_init(&ctx->to_compute, ADFGVX_PIPELINE_CHUNK);
+    ring_status |= ring_init(&ctx->to_write, 2 * (long)ADFGVX_PIPELINE_CHUNK);
+    ctx->formatted = malloc((size_t)adfgvx_format_size(2 * (long)ADFGVX_PIPELINE_CHUNK, group_size));
+    if (ring_status != 0 || ctx->formatted == NULL)
+        status = 1;
+
+    if (status == 0)
+    {
+        // Contagem com um buffer de leitura, antes de as threads existirem.
+        double count_start = wall_seconds();
+        status = count_symbols(ctx->input, ctx->to_compute.slots[0].data, &total_symbols);
+        ctx->stats.count_seconds = wall_seconds() - count_start;
+    }
+
+    if (status == 0 && total_symbols > 0)
+    {
+        // Pre-aloca o arquivo gravando o ultimo byte (a quebra de linha final, no formato em grupos).
+        int64_t formatted_size = formatted_offset(total_symbols - 1, group_size) + 1 + (group_size > 0 ? 1 : 0);
+        compute_column_starts(key, key_length, total_symbols, ctx->column_start);
+        if (file_seek_64(ctx->output, formatted_size - 1, SEEK_SET) != 0 || fputc(group_size > 0 ? '\n' : '\0', ctx->output) == EOF)
+        {
+            perror("Erro ao escrever no arquivo de saida cifrada");
+            status = 1;
+        }
+    }
+
+    if (status != 0 || pthread_create(&reader, NULL, reader_run, ctx) != 0)
+    {
+        status = 1;
+    }
+    else if (pthread_create(&writer, NULL, writer_run, ctx) != 0)
+    {
+        // Sem escritor: drena a leitura para encerrar a thread de leitura.
+        for (;;)
+        {
+            int end = ring_acquire(&ctx->to_compute)->end;
+            ring_release(&ctx->to_compute);
+            if (end)
+                break;
+        }
+        pthread_join(reader, NULL);
+        status = 1;
+    }
+    else
+    {
+        // Etapa de calculo, na thread chamadora.
+        for (;;)
+        {
+            pipeline_slot *in = ring_acquire(&ctx->to_compute);
+            pipeline_slot *out = ring_acquire_free(&ctx->to_write);
+
+            out->end = in->end;
+            if (!in->end)
+            {
+                double compute_start = wall_seconds();
+                // So a coluna do primeiro simbolo importa: passa first_symbol % key_length.
+                out->first_symbol = next_symbol;
+                out->length = adfgvx_store_encode_chunk(key_length, (long)(next_symbol % key_length), in->data,
+                                                        in->length, out->data, out->column_fill);
+                ctx->stats.compute_seconds += wall_seconds() - compute_start;
+                next_symbol += out->length;
+            }
+
+            int end = in->end;
+            ring_publish(&ctx->to_write);
+            ring_release(&ctx->to_compute);
+            if (end)
+                break;
+        }
+
+        pthread_join(reader, NULL);
+        pthread_join(writer, NULL);
+        status = ctx->read_status != 0 ? ctx->read_status : ctx->write_status;
+
+        // O arquivo de entrada mudou entre a contagem e a cifragem: as posicoes gravadas nao valem.
+        if (status == 0 && next_symbol != total_symbols)
+            status = 1;
+    }
+
+    if (fclose(ctx->output) != 0 && status == 0)
+    {
+        perror("Erro ao escrever no arquivo de saida cifrada");
+        status = 1;
+    }
+    fclose(ctx->input);
+    ring_destroy(&ctx->to_compute);
+    ring_destroy(&ctx->to_write);
+    free(ctx->formatted);
+
+    ctx->stats.wall_seconds = wall_seconds() - start_time;
+    if (stats != NULL)
+        *stats = ctx->stats;
+    free(ctx);
+    return status;
+}
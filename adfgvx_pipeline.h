@@ -0,0 +1,62 @@
+#ifndef ADFGVX_PIPELINE_H
+#define ADFGVX_PIPELINE_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH
+
+// Tamanho (em caracteres de texto) de cada trecho que circula pelo pipeline.
+#define ADFGVX_PIPELINE_CHUNK 65536
+
+// Numero de posicoes em cada buffer circular (leitura -> calculo e calculo -> escrita).
+#define ADFGVX_PIPELINE_SLOTS 4
+
+/**
+ * @brief Tempos medidos por etapa. Com sobreposicao, o tempo do pipeline (wall_seconds menos
+ * count_seconds) se aproxima do maior entre read_seconds, compute_seconds e write_seconds,
+ * em vez da soma.
+ */
+typedef struct adfgvx_pipeline_stats
+{
+    long bytes_read;
+    long symbols_written;
+    double count_seconds;       // Passada inicial de contagem dos simbolos (somente leitura).
+    double read_seconds;        // Tempo ocupado da thread de leitura.
+    double compute_seconds;     // Tempo ocupado da etapa de calculo.
+    double write_seconds;       // Tempo ocupado da thread de escrita.
+    double wall_seconds;        // Tempo total de ponta a ponta.
+} adfgvx_pipeline_stats;
+
+/**
+ * @brief Cifra um arquivo de qualquer tamanho sobrepondo leitura, calculo e escrita.
+ *
+ * A posicao final de cada coluna da transposicao depende do total de simbolos, entao uma
+ * passada inicial, somente de leitura, conta os caracteres da matriz. Com o total conhecido,
+ * o arquivo cifrado e pre-alocado e o pipeline comeca: uma thread le trechos de
+ * ADFGVX_PIPELINE_CHUNK caracteres, a thread chamadora cifra cada trecho e agrupa os simbolos
+ * por coluna (adfgvx_store_encode_chunk()), e uma terceira thread formata cada grupo
+ * (adfgvx_format_ciphertext()) e o grava diretamente na sua posicao final, calculada em forma
+ * fechada. As etapas sao ligadas por buffers circulares de ADFGVX_PIPELINE_SLOTS posicoes,
+ * entao o trecho N e cifrado enquanto o N+1 e lido e o N-1 e gravado. Nao ha arquivos
+ * intermediarios nem passada final de linearizacao.
+ *
+ * O resultado e o mesmo de write_ciphertext_to_file() para a mensagem inteira (caracteres
+ * fora da matriz, inclusive quebras de linha, sao ignorados), com quebras de linha '\n'.
+ *
+ * @param message_filename Arquivo com o texto plano.
+ * @param key Chave de cifra.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @param encrypted_filename Arquivo onde o texto cifrado sera gravado.
+ * @param group_size Simbolos por grupo (ADFGVX_GROUP_SIZE; 0 para texto linear).
+ * @param groups_per_line Grupos por linha (ADFGVX_GROUPS_PER_LINE; 0 para uma unica linha).
+ * @param stats Tempos por etapa (pode ser NULL).
+ * @return int 0 em caso de sucesso, 1 se erro de leitura, escrita ou criacao de threads (ou se
+ * o arquivo de entrada mudar durante a cifragem), 2 se parametros invalidos.
+ */
+int adfgvx_pipeline_encrypt_file(const char *message_filename,
+                                 const char *key,
+                                 int key_length,
+                                 const char *encrypted_filename,
+                                 int group_size,
+                                 int groups_per_line,
+                                 adfgvx_pipeline_stats *stats);
+
+#endif // ADFGVX_PIPELINE_H
@@ -0,0 +1,620 @@
+#define _POSIX_C_SOURCE 200809L // Para fork, pipe, poll, sigaction e clock_gettime
+#include "adfgvx_shard.h"
+#include "adfgvx_decipher.h"
+#include "file_operations.h" // Para file_sync, file_replace
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Teste de falhas (adfgvx_shard_test_set_worker_exit()): ordenacoes ate o _exit() do primeiro
+// trabalhador, ou 0 para nunca.
+static long worker_exit_after_orderings = 0;
+
+// Estados de um shard no coordenador.
+#define SHARD_PENDING 0
+#define SHARD_RUNNING 1
+#define SHARD_DONE 2
+
+// 100 * log10 da frequencia de cada letra (A-Z) em textos em portugues, ja descontados os espacos.
+static const short letter_weight[26] = {
+    -92, -206, -149, -138, -98, -207, -197, -197, -129, -248, -378, -164, -141,
+    -138, -105, -168, -200, -127, -119, -144, -142, -186, -408, -276, -408, -241};
+#define SPACE_WEIGHT (-80)  // Cerca de 16% dos caracteres.
+#define OTHER_WEIGHT (-270) // Digitos e pontuacao.
+
+double adfgvx_plaintext_score(const char *plaintext)
+{
+    long total = 0;
+    long count = 0;
+
+    for (; *plaintext != '\0'; plaintext++, count++)
+    {
+        char c = *plaintext;
+        if (c >= 'A' && c <= 'Z')
+            total += letter_weight[c - 'A'];
+        else if (c == ' ')
+            total += SPACE_WEIGHT;
+        else
+            total += OTHER_WEIGHT;
+    }
+    return count > 0 ? (double)total / (100.0 * count) : -4.0;
+}
+
+void adfgvx_ordering_key(long ordering, int key_length, char *key)
+{
+    int available[MAX_KEY_LENGTH];
+    long factorial = 1;
+
+    for (int i = 0; i < key_length; i++)
+    {
+        available[i] = i;
+        if (i > 0)
+            factorial *= i; // (key_length - 1)! ao final
+    }
+
+    // Decomposicao do indice no sistema fatorial (codigo de Lehmer).
+    for (int i = 0; i < key_length; i++)
+    {
+        int remaining = key_length - i;
+        int digit = (int)(ordering / factorial);
+        ordering %= factorial;
+        if (remaining > 1)
+            factorial /= remaining - 1;
+
+        int column = available[digit];
+        memmove(available + digit, available + digit + 1, (size_t)(remaining - digit - 1) * sizeof(int));
+        // A coluna original column e a i-esima no texto cifrado: recebe a i-esima letra.
+        key[column] = (char)('A' + i);
+    }
+    key[key_length] = '\0';
+}
+
+#if !defined(_WIN32)
+
+/**
+ * @brief Compara resultados: maior pontuacao primeiro; empate pelo menor indice (resultado
+ * independente da divisao em shards e da ordem em que eles terminam).
+ * (Funcao auxiliar estatica)
+ */
+static int compare_results(const adfgvx_shard_result *a, const adfgvx_shard_result *b)
+{
+    if (a->score != b->score)
+        return a->score < b->score ? 1 : -1;
+    return a->ordering < b->ordering ? -1 : (a->ordering > b->ordering);
+}
+
+/**
+ * @brief Insere um resultado na lista ordenada, mantendo apenas os top_n melhores.
+ * (Funcao auxiliar estatica)
+ */
+static void insert_result(adfgvx_shard_result *results, int *count, int top_n, const adfgvx_shard_result *candidate)
+{
+    int n = *count;
+
+    if (n == top_n)
+    {
+        if (compare_results(candidate, &results[n - 1]) >= 0)
+            return;
+        n--;
+    }
+    int pos = n;
+    while (pos > 0 && compare_results(candidate, &results[pos - 1]) < 0)
+    {
+        results[pos] = results[pos - 1];
+        pos--;
+    }
+    results[pos] = *candidate;
+    *count = n + 1;
+}
+
+/**
+ * @brief Hash FNV-1a de 64 bits do texto cifrado, para reconhecer o checkpoint da mesma busca.
+ * (Funcao auxiliar estatica)
+ */
+static uint64_t text_hash(const char *text, long length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (long i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)text[i]) * 1099511628211ULL;
+    return hash;
+}
+
+/**
+ * @brief Grava o checkpoint: problema, shards concluidos e melhores resultados.
+ * O arquivo e escrito em filename.tmp, sincronizado no disco e so entao colocado no lugar do
+ * anterior (file_replace()), para nunca ficar vazio ou pela metade, nem depois de uma queda.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de escrita.
+ */
+static int checkpoint_save(const adfgvx_shard_config *config, long text_length, uint64_t hash,
+                           const unsigned char *state, long shard_count, const adfgvx_shard_report *report)
+{
+    char temp_name[1024];
+    if (snprintf(temp_name, sizeof(temp_name), "%s.tmp", config->checkpoint_file) >= (int)sizeof(temp_name))
+        return 1;
+
+    FILE *output_file_ptr = fopen(temp_name, "w");
+    if (output_file_ptr == NULL)
+    {
+        perror("Erro ao abrir arquivo para escrita do checkpoint");
+        return 1;
+    }
+
+    fprintf(output_file_ptr, "# Checkpoint da busca de chaves ADFGVX (gerado por adfgvx_shard_search)\n");
+    fprintf(output_file_ptr, "# problem comprimento_chave ordenacoes_por_shard top_n simbolos hash_do_texto\n");
+    fprintf(output_file_ptr, "problem %d %ld %d %ld %016llx\n", config->key_length, config->shard_size,
+            config->top_n, text_length, (unsigned long long)hash);
+    for (long s = 0; s < shard_count; s++)
+    {
+        if (state[s] == SHARD_DONE)
+            fprintf(output_file_ptr, "done %ld\n", s);
+    }
+    for (int r = 0; r < report->result_count; r++)
+        fprintf(output_file_ptr, "result %ld %.17g\n", report->results[r].ordering, report->results[r].score);
+
+    int status = file_sync(output_file_ptr);
+    if (fclose(output_file_ptr) != 0 || status != 0 || file_replace(temp_name, config->checkpoint_file) != 0)
+    {
+        perror("Erro ao gravar o checkpoint");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Le um checkpoint existente da mesma busca, marcando os shards concluidos.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 se lido (ou inexistente), 2 se de outra busca ou mal formado.
+ */
+static int checkpoint_load(const adfgvx_shard_config *config, long text_length, uint64_t hash, long ordering_count,
+                           unsigned char *state, long shard_count, adfgvx_shard_report *report)
+{
+    char line[128];
+    int problem_seen = 0;
+    FILE *file_ptr = fopen(config->checkpoint_file, "r");
+    if (file_ptr == NULL)
+    {
+        return 0; // Primeira execucao.
+    }
+
+    while (fgets(line, sizeof(line), file_ptr) != NULL)
+    {
+        int key_length, top_n;
+        long shard_size, length, value;
+        unsigned long long saved_hash;
+        double score;
+        int valid = 0;
+
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        if (sscanf(line, "problem %d %ld %d %ld %llx", &key_length, &shard_size, &top_n, &length, &saved_hash) == 5)
+        {
+            valid = key_length == config->key_length && shard_size == config->shard_size &&
+                    top_n == config->top_n && length == text_length && saved_hash == (unsigned long long)hash;
+            problem_seen = valid;
+        }
+        else if (problem_seen && sscanf(line, "done %ld", &value) == 1)
+        {
+            valid = value >= 0 && value < shard_count;
+            if (valid && state[value] != SHARD_DONE)
+            {
+                state[value] = SHARD_DONE;
+                report->shards_resumed++;
+            }
+        }
+        else if (problem_seen && sscanf(line, "result %ld %lg", &value, &score) == 2 &&
+                 value >= 0 && value < ordering_count)
+        {
+            adfgvx_shard_result result;
+            result.ordering = value;
+            result.score = score;
+            adfgvx_ordering_key(value, config->key_length, result.key);
+            insert_result(report->results, &report->result_count, config->top_n, &result);
+            valid = 1;
+        }
+
+        if (!valid)
+        {
+            fclose(file_ptr);
+            return 2;
+        }
+    }
+    fclose(file_ptr);
+    return 0;
+}
+
+/**
+ * @brief Resposta de um trabalhador: os melhores resultados de um shard.
+ */
+typedef struct shard_reply
+{
+    long shard;
+    long evaluated;
+    int count;
+    adfgvx_shard_result results[ADFGVX_SHARD_MAX_RESULTS];
+} shard_reply;
+
+/**
+ * @brief Um processo trabalhador, visto pelo coordenador.
+ */
+typedef struct shard_worker
+{
+    pid_t pid;
+    int command_fd; // Coordenador -> trabalhador: numero do shard (negativo para encerrar).
+    int reply_fd;   // Trabalhador -> coordenador: shard_reply.
+    long shard;     // Shard em andamento, ou -1 se ocioso.
+    int alive;
+} shard_worker;
+
+/**
+ * @brief Tempo de relogio (em segundos) para medir a vazao com varios processos.
+ * (Funcao auxiliar estatica)
+ */
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Le exatamente size bytes de um descritor.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se fim de arquivo ou erro.
+ */
+static int read_full(int fd, void *buffer, size_t size)
+{
+    char *p = buffer;
+
+    while (size > 0)
+    {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 1;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Escreve exatamente size bytes em um descritor.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro (ex.: o outro lado morreu).
+ */
+static int write_full(int fd, const void *buffer, size_t size)
+{
+    const char *p = buffer;
+
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 1;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decifra todas as ordenacoes de um shard e guarda as top_n melhores.
+ * (Funcao auxiliar estatica)
+ *
+ * @param exit_countdown Ordenacoes ate o _exit() simulado (ver worker_exit_after_orderings; 0: nunca).
+ */
+static void evaluate_shard(const adfgvx_shard_config *config, long ordering_count, long shard,
+                           long *exit_countdown, shard_reply *reply)
+{
+    char plaintext[MAX_MESSAGE_LENGTH];
+    long first = shard * config->shard_size;
+    long last = first + config->shard_size < ordering_count ? first + config->shard_size : ordering_count;
+
+    reply->shard = shard;
+    reply->evaluated = last - first;
+    reply->count = 0;
+    for (long ordering = first; ordering < last; ordering++)
+    {
+        adfgvx_shard_result result;
+        result.ordering = ordering;
+        adfgvx_ordering_key(ordering, config->key_length, result.key);
+        decipher_adfgvx((char *)config->ciphertext, result.key, config->key_length, plaintext);
+        result.score = adfgvx_plaintext_score(plaintext);
+        insert_result(reply->results, &reply->count, config->top_n, &result);
+        if (*exit_countdown > 0 && --*exit_countdown == 0)
+            _exit(1); // Morte simulada no meio do shard, sem resposta ao coordenador.
+    }
+}
+
+/**
+ * @brief Laco de um processo trabalhador: recebe shards ate o pedido de encerramento.
+ * (Funcao auxiliar estatica)
+ */
+static void worker_main(const adfgvx_shard_config *config, long ordering_count, int worker_index,
+                        int command_fd, int reply_fd)
+{
+    long shard;
+    shard_reply reply;
+    long exit_countdown = worker_index == 0 ? worker_exit_after_orderings : 0;
+
+    while (read_full(command_fd, &shard, sizeof(shard)) == 0 && shard >= 0)
+    {
+        memset(&reply, 0, sizeof(reply));
+        evaluate_shard(config, ordering_count, shard, &exit_countdown, &reply);
+        if (write_full(reply_fd, &reply, sizeof(reply)) != 0)
+            break;
+    }
+}
+
+/**
+ * @brief Encerra um trabalhador: fecha os pipes (o que o faz sair do laco) e aguarda o processo.
+ * (Funcao auxiliar estatica)
+ */
+static void stop_worker(shard_worker *worker)
+{
+    long stop = -1;
+
+    if (worker->pid <= 0)
+        return;
+    if (worker->alive)
+        write_full(worker->command_fd, &stop, sizeof(stop));
+    close(worker->command_fd);
+    close(worker->reply_fd);
+    waitpid(worker->pid, NULL, 0);
+    worker->pid = -1;
+    worker->alive = 0;
+}
+
+/**
+ * @brief Cria os processos trabalhadores, cada um com um pipe de pedidos e um de respostas.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int Numero de trabalhadores criados.
+ */
+static int start_workers(const adfgvx_shard_config *config, long ordering_count, shard_worker *workers)
+{
+    int started = 0;
+
+    fflush(NULL); // Evita que buffers de stdio sejam duplicados nos filhos.
+    for (; started < config->worker_count; started++)
+    {
+        int command_pipe[2], reply_pipe[2];
+        if (pipe(command_pipe) != 0)
+            break;
+        if (pipe(reply_pipe) != 0)
+        {
+            close(command_pipe[0]);
+            close(command_pipe[1]);
+            break;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(command_pipe[0]);
+            close(command_pipe[1]);
+            close(reply_pipe[0]);
+            close(reply_pipe[1]);
+            break;
+        }
+        if (pid == 0)
+        {
+            // Filho: so mantem as suas duas pontas dos pipes.
+            for (int w = 0; w < started; w++)
+            {
+                close(workers[w].command_fd);
+                close(workers[w].reply_fd);
+            }
+            close(command_pipe[1]);
+            close(reply_pipe[0]);
+            worker_main(config, ordering_count, started, command_pipe[0], reply_pipe[1]);
+            _exit(0);
+        }
+
+        close(command_pipe[0]);
+        close(reply_pipe[1]);
+        workers[started].pid = pid;
+        workers[started].command_fd = command_pipe[1];
+        workers[started].reply_fd = reply_pipe[0];
+        workers[started].shard = -1;
+        workers[started].alive = 1;
+    }
+    return started;
+}
+
+/**
+ * @brief Distribui os shards pendentes, junta as respostas e grava o checkpoint a cada shard.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de checkpoint ou se todos os trabalhadores morrerem.
+ */
+static int coordinate(const adfgvx_shard_config *config, long text_length, uint64_t hash, unsigned char *state,
+                      long shard_count, shard_worker *workers, int worker_count, struct pollfd *poll_fds,
+                      adfgvx_shard_report *report)
+{
+    long next_shard = 0;
+    long dispatched = 0; // Shards entregues nesta execucao (limitados por max_shards).
+    shard_reply reply;
+
+    for (;;)
+    {
+        // Entrega o proximo shard pendente (menor indice primeiro) a cada trabalhador ocioso.
+        for (int w = 0; w < worker_count; w++)
+        {
+            if (!workers[w].alive || workers[w].shard >= 0)
+                continue;
+            while (next_shard < shard_count && state[next_shard] != SHARD_PENDING)
+                next_shard++;
+            if (next_shard == shard_count || (config->max_shards > 0 && dispatched >= config->max_shards))
+                break;
+            if (write_full(workers[w].command_fd, &next_shard, sizeof(next_shard)) != 0)
+            {
+                workers[w].alive = 0;
+                report->worker_failures++;
+                continue;
+            }
+            state[next_shard] = SHARD_RUNNING;
+            workers[w].shard = next_shard;
+            dispatched++;
+        }
+
+        int running = 0;
+        for (int w = 0; w < worker_count; w++)
+        {
+            if (workers[w].alive && workers[w].shard >= 0)
+            {
+                poll_fds[running].fd = workers[w].reply_fd;
+                poll_fds[running].events = POLLIN;
+                poll_fds[running].revents = 0;
+                running++;
+            }
+        }
+        if (running == 0)
+            break;
+
+        if (poll(poll_fds, (nfds_t)running, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return 1;
+        }
+
+        for (int w = 0; w < worker_count; w++)
+        {
+            shard_worker *worker = &workers[w];
+            int ready = 0;
+            for (int p = 0; p < running; p++)
+                ready |= poll_fds[p].fd == worker->reply_fd && poll_fds[p].revents != 0;
+            if (!ready || !worker->alive || worker->shard < 0)
+                continue;
+
+            if (read_full(worker->reply_fd, &reply, sizeof(reply)) != 0 || reply.shard != worker->shard)
+            {
+                // Trabalhador morreu: o shard volta para a fila dos demais.
+                state[worker->shard] = SHARD_PENDING;
+                if (worker->shard < next_shard)
+                    next_shard = worker->shard;
+                dispatched--;
+                worker->shard = -1;
+                worker->alive = 0;
+                report->worker_failures++;
+                continue;
+            }
+
+            for (int r = 0; r < reply.count; r++)
+                insert_result(report->results, &report->result_count, config->top_n, &reply.results[r]);
+            state[reply.shard] = SHARD_DONE;
+            report->shards_done++;
+            report->orderings_evaluated += reply.evaluated;
+            worker->shard = -1;
+
+            if (config->checkpoint_file != NULL &&
+                checkpoint_save(config, text_length, hash, state, shard_count, report) != 0)
+            {
+                return 1;
+            }
+        }
+    }
+
+    report->complete = report->shards_done == shard_count;
+    if (!report->complete && (config->max_shards <= 0 || dispatched < config->max_shards))
+        return 1; // Sobrou trabalho, mas nenhum trabalhador vivo.
+    return 0;
+}
+
+#endif // !defined(_WIN32)
+
+void adfgvx_shard_test_set_worker_exit(long orderings)
+{
+    worker_exit_after_orderings = orderings > 0 ? orderings : 0;
+}
+
+int adfgvx_shard_search(const adfgvx_shard_config *config, adfgvx_shard_report *report)
+{
+    if (config == NULL || report == NULL || config->ciphertext == NULL || config->key_length <= 0 ||
+        config->key_length >= MAX_KEY_LENGTH || config->shard_size <= 0 || config->worker_count <= 0 ||
+        config->top_n <= 0 || config->top_n > ADFGVX_SHARD_MAX_RESULTS || config->max_shards < 0)
+    {
+        return 2;
+    }
+
+    long text_length = (long)strlen(config->ciphertext);
+    if (text_length > 2 * (MAX_MESSAGE_LENGTH - 1))
+        return 2; // decipher_adfgvx() escreve no maximo MAX_MESSAGE_LENGTH caracteres.
+
+    memset(report, 0, sizeof(*report));
+    long ordering_count = 1;
+    for (int i = 2; i <= config->key_length; i++)
+        ordering_count *= i;
+    long shard_count = (ordering_count + config->shard_size - 1) / config->shard_size;
+    report->shard_count = shard_count;
+
+#if defined(_WIN32)
+    return 1; // fork() e pipes POSIX nao estao disponiveis.
+#else
+    uint64_t hash = text_hash(config->ciphertext, text_length);
+    double start_time = wall_seconds();
+    unsigned char *state = calloc((size_t)shard_count, 1);
+    shard_worker *workers = calloc((size_t)config->worker_count, sizeof(shard_worker));
+    struct pollfd *poll_fds = calloc((size_t)config->worker_count, sizeof(struct pollfd));
+    int status = 1;
+
+    if (state != NULL && workers != NULL && poll_fds != NULL)
+    {
+        status = 0;
+        if (config->checkpoint_file != NULL)
+            status = checkpoint_load(config, text_length, hash, ordering_count, state, shard_count, report);
+        report->shards_done = report->shards_resumed;
+    }
+
+    if (status == 0 && report->shards_done < shard_count)
+    {
+        // Escrever para um trabalhador morto nao deve encerrar o coordenador.
+        struct sigaction ignore_pipe, previous_pipe;
+        memset(&ignore_pipe, 0, sizeof(ignore_pipe));
+        ignore_pipe.sa_handler = SIG_IGN;
+        sigemptyset(&ignore_pipe.sa_mask);
+        sigaction(SIGPIPE, &ignore_pipe, &previous_pipe);
+
+        int worker_count = start_workers(config, ordering_count, workers);
+        if (worker_count == 0)
+            status = 1;
+        else
+            status = coordinate(config, text_length, hash, state, shard_count, workers, worker_count, poll_fds, report);
+
+        for (int w = 0; w < worker_count; w++)
+            stop_worker(&workers[w]);
+        sigaction(SIGPIPE, &previous_pipe, NULL);
+    }
+    report->complete = report->shards_done == shard_count;
+
+    report->elapsed_seconds = wall_seconds() - start_time;
+    if (report->elapsed_seconds > 0.0)
+        report->orderings_per_second = report->orderings_evaluated / report->elapsed_seconds;
+    free(state);
+    free(workers);
+    free(poll_fds);
+    return status;
+#endif
+}
@@ -0,0 +1,101 @@
+#ifndef ADFGVX_SHARD_H
+#define ADFGVX_SHARD_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH, MAX_MESSAGE_LENGTH
+
+// Numero padrao de processos trabalhadores.
+#define ADFGVX_SHARD_WORKERS 4
+
+// Numero padrao de ordenacoes da transposicao por shard.
+#define ADFGVX_SHARD_SIZE 1024
+
+// Maior numero de resultados guardados (top-N) no relatorio e no checkpoint.
+#define ADFGVX_SHARD_MAX_RESULTS 32
+
+/**
+ * @brief Uma ordenacao candidata e a pontuacao do texto que ela decifra.
+ */
+typedef struct adfgvx_shard_result
+{
+    long ordering;             // Indice da permutacao (ordem lexicografica de order[]).
+    double score;              // Media do log10 da frequencia de cada caractere; maior e melhor.
+    char key[MAX_KEY_LENGTH];  // Chave canonica equivalente, aceita por decipher_adfgvx().
+} adfgvx_shard_result;
+
+/**
+ * @brief Parametros de uma busca distribuida.
+ */
+typedef struct adfgvx_shard_config
+{
+    const char *ciphertext;      // Texto cifrado linearizado (ate 2 * (MAX_MESSAGE_LENGTH - 1) simbolos).
+    int key_length;              // Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+    long shard_size;             // Ordenacoes por shard (ADFGVX_SHARD_SIZE na duvida).
+    int worker_count;            // Processos trabalhadores (ADFGVX_SHARD_WORKERS na duvida).
+    int top_n;                   // Resultados guardados (1 a ADFGVX_SHARD_MAX_RESULTS).
+    const char *checkpoint_file; // Arquivo de checkpoint (NULL: sem checkpoint nem retomada).
+    long max_shards;             // Shards a concluir nesta execucao (0: ate o fim).
+} adfgvx_shard_config;
+
+/**
+ * @brief Melhores resultados e metricas de uma busca distribuida.
+ */
+typedef struct adfgvx_shard_report
+{
+    adfgvx_shard_result results[ADFGVX_SHARD_MAX_RESULTS]; // Do melhor para o pior.
+    int result_count;
+    long shard_count;            // Total de shards do espaco de ordenacoes.
+    long shards_done;            // Shards concluidos, incluindo os de execucoes anteriores.
+    long shards_resumed;         // Shards ja concluidos no checkpoint lido.
+    long orderings_evaluated;    // Ordenacoes decifradas nesta execucao.
+    int complete;                // 1 se todos os shards foram concluidos.
+    int worker_failures;         // Trabalhadores que terminaram antes da hora (seus shards sao refeitos).
+    double elapsed_seconds;
+    double orderings_per_second;
+} adfgvx_shard_report;
+
+/**
+ * @brief Pontua um texto decifrado pela frequencia das letras em portugues.
+ *
+ * @return double Media, por caractere, do log10 da frequencia esperada (entre -4 e 0).
+ */
+double adfgvx_plaintext_score(const char *plaintext);
+
+/**
+ * @brief Converte o indice de uma permutacao na chave canonica equivalente.
+ * A i-esima coluna do texto cifrado (ordem alfabetica) e a coluna original order[i], onde
+ * order[] e a permutacao de indice ordering em ordem lexicografica.
+ *
+ * @param key Buffer de key_length + 1 posicoes.
+ */
+void adfgvx_ordering_key(long ordering, int key_length, char *key);
+
+/**
+ * @brief Busca a ordenacao da transposicao em varios processos, com checkpoint e retomada.
+ *
+ * O espaco das key_length! ordenacoes e dividido em shards consecutivos pelo indice da
+ * permutacao. O coordenador cria worker_count processos com fork(), e cada um recebe
+ * numeros de shard por um pipe, decifra todas as ordenacoes do shard com decipher_adfgvx(),
+ * e devolve pelo outro pipe os seus top_n melhores. Nao ha memoria compartilhada.
+ *
+ * Cada shard concluido e gravado no checkpoint (reescrito em um arquivo temporario e
+ * renomeado, para nunca ficar pela metade) junto com os melhores resultados ate o momento.
+ * Se o arquivo ja existir, os shards concluidos sao pulados: uma busca interrompida continua
+ * de onde parou. Se um trabalhador morrer, seu shard volta para a fila dos demais.
+ * Disponivel apenas em sistemas POSIX.
+ *
+ * @param config Parametros da busca.
+ * @param report Relatorio a ser preenchido.
+ * @return int 0 em caso de sucesso (report->complete indica se a busca terminou), 1 se erro
+ * ao criar processos ou gravar o checkpoint ou se todos os trabalhadores morrerem, 2 se
+ * parametros invalidos ou checkpoint de outra busca.
+ */
+int adfgvx_shard_search(const adfgvx_shard_config *config, adfgvx_shard_report *report);
+
+/**
+ * @brief Apenas para testes: nas buscas seguintes, o primeiro trabalhador sai com _exit()
+ * depois de decifrar essa quantidade de ordenacoes, simulando a morte de um processo no
+ * meio de um shard. 0 (o padrao) desativa a falha.
+ */
+void adfgvx_shard_test_set_worker_exit(long orderings);
+
+#endif // ADFGVX_SHARD_H
@@ -0,0 +1,369 @@
+#include "adfgvx_stream.h"
+#include "adfgvx_core.h" // Para adfgvx_key_order
+#include "adfgvx_grid.h" // Matriz e simbolos da cifra (adfgvx_grid_*)
+#include "adfgvx_format.h" // Para adfgvx_ingest_ciphertext
+#include "file_operations.h" // Para file_seek_64, file_tell_64
+#include <stddef.h> // Para offsetof
+#include <string.h>
+
+/**
+ * @brief Calcula a posicao inicial e o tamanho de cada coluna original dentro do texto cifrado.
+ * (Funcao auxiliar estatica)
+ *
+ * Usa a mesma aritmetica de reverse_transposition(): a coluna original c tem
+ * rows + (c < extra ? 1 : 0) simbolos, e as colunas aparecem no texto cifrado
+ * na ordem alfabetica (estavel) da chave.
+ *
+ * @return int 0 em caso de sucesso, 2 se o texto cifrado nao puder ser decifrado.
+ */
+static int setup_columns(adfgvx_decipher_stream *stream, const char *key, int key_length)
+{
+    int order[MAX_KEY_LENGTH];
+    int64_t rows, extra, pos;
+
+    if (key == NULL || key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+        return 2;
+    if (stream->total_symbols % 2 != 0) // Nao pode decodificar numero impar de simbolos
+        return 2;
+
+    adfgvx_key_order(key, key_length, order);
+
+    rows = stream->total_symbols / key_length;
+    extra = stream->total_symbols % key_length;
+    pos = stream->data_offset;
+
+    for (int i = 0; i < key_length; i++)
+    {
+        int col = order[i];
+        int64_t count = rows + (col < extra ? 1 : 0);
+
+        // Com segmentos por coluna, cada coluna comeca no inicio do seu proprio arquivo.
+        stream->column_offset[col] = stream->column_file[col] != NULL ? 0 : pos;
+        stream->column_remaining[col] = count;
+        stream->window[col] = NULL;
+        stream->window_length[col] = 0;
+        stream->window_pos[col] = 0;
+        pos += count;
+    }
+
+    stream->key_length = key_length;
+    stream->next_column = 0;
+    stream->symbols_read = 0;
+    stream->status = 0;
+    return 0;
+}
+
+/**
+ * @brief Carrega a proxima janela de uma coluna em arquivo com separadores: le ate
+ * ADFGVX_STREAM_COLUMN_BUFFER bytes a partir do cursor e compacta os simbolos no proprio buffer.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 1 se a janela foi carregada, 0 em caso de erro de leitura.
+ */
+static int refill_grouped_column(adfgvx_decipher_stream *stream, int col)
+{
+    char *buffer = stream->column_buffer[col];
+    long count = 0;
+
+    if (file_seek_64(stream->file, stream->column_offset[col], SEEK_SET) != 0)
+        return 0;
+
+    // Um trecho so com separadores (nao ocorre no formato padrao) e pulado.
+    while (count == 0)
+    {
+        size_t raw = fread(buffer, 1, ADFGVX_STREAM_COLUMN_BUFFER, stream->file);
+        if (raw == 0 || adfgvx_ingest_ciphertext(buffer, (long)raw, buffer, &count, NULL) != 0)
+            return 0;
+        stream->column_offset[col] += (int64_t)raw;
+    }
+
+    // O fim da janela pode conter o inicio da coluna seguinte.
+    if (count > stream->column_remaining[col])
+        count = (long)stream->column_remaining[col];
+    stream->window[col] = buffer;
+    stream->window_length[col] = (int)count;
+    stream->window_pos[col] = 0;
+    stream->column_remaining[col] -= count;
+    return 1;
+}
+
+/**
+ * @brief Carrega a proxima janela de simbolos de uma coluna original.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 1 se a janela foi carregada, 0 em caso de erro de leitura ou coluna esgotada.
+ */
+static int refill_column(adfgvx_decipher_stream *stream, int col)
+{
+    int64_t n = stream->column_remaining[col];
+
+    if (n <= 0)
+        return 0;
+    if (stream->grouped)
+        return refill_grouped_column(stream, col);
+    if (n > ADFGVX_STREAM_COLUMN_BUFFER)
+        n = ADFGVX_STREAM_COLUMN_BUFFER;
+
+    if (stream->memory != NULL)
+    {
+        stream->window[col] = stream->memory + stream->column_offset[col];
+    }
+    else
+    {
+        FILE *source = stream->column_file[col] != NULL ? stream->column_file[col] : stream->file;
+        if (file_seek_64(source, stream->column_offset[col], SEEK_SET) != 0 ||
+            fread(stream->column_buffer[col], 1, (size_t)n, source) != (size_t)n)
+        {
+            return 0;
+        }
+        stream->window[col] = stream->column_buffer[col];
+    }
+
+    stream->window_length[col] = (int)n;
+    stream->window_pos[col] = 0;
+    stream->column_offset[col] += n;
+    stream->column_remaining[col] -= n;
+    return 1;
+}
+
+/**
+ * @brief Le o proximo simbolo da sequencia intermediaria (linha a linha, colunas na ordem original).
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 1 se um simbolo foi lido, 0 em caso de erro de leitura.
+ */
+static int next_symbol(adfgvx_decipher_stream *stream, char *symbol)
+{
+    int col = stream->next_column;
+
+    if (stream->window_pos[col] == stream->window_length[col] && !refill_column(stream, col))
+        return 0;
+
+    *symbol = stream->window[col][stream->window_pos[col]++];
+    stream->symbols_read++;
+    if (++stream->next_column == stream->key_length)
+        stream->next_column = 0;
+    return 1;
+}
+
+/**
+ * @brief Le o arquivo do inicio ao fim contando os simbolos (e validando o alfabeto). Se
+ * target_count > 0, tambem grava em offsets[i] o byte do simbolo de indice targets[i]
+ * (targets em ordem crescente). Usa os buffers de coluna como area temporaria.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de leitura, 2 se houver caractere invalido.
+ */
+static int scan_file(adfgvx_decipher_stream *stream, const int64_t targets[], int64_t offsets[],
+                     int target_count, int64_t *symbol_count)
+{
+    char *raw = stream->column_buffer[0];
+    char *symbols = stream->column_buffer[1];
+    int64_t position = 0;
+    int64_t total = 0;
+    int next = 0;
+    size_t n;
+
+    if (file_seek_64(stream->file, 0, SEEK_SET) != 0)
+        return 1;
+
+    while ((n = fread(raw, 1, ADFGVX_STREAM_COLUMN_BUFFER, stream->file)) > 0)
+    {
+        long count;
+        if (adfgvx_ingest_ciphertext(raw, (long)n, symbols, &count, NULL) != 0)
+            return 2;
+
+        // So os trechos com o inicio de uma coluna (no maximo key_length) sao percorridos byte a byte.
+        for (; next < target_count && targets[next] < total + count; next++)
+        {
+            int64_t seen = total;
+            size_t b = 0;
+            for (;; b++)
+            {
+                if (adfgvx_grid_symbol_index(raw[b]) >= 0)
+                {
+                    if (seen == targets[next])
+                        break;
+                    seen++;
+                }
+            }
+            offsets[next] = position + (int64_t)b;
+        }
+        position += (int64_t)n;
+        total += count;
+    }
+
+    if (ferror(stream->file))
+        return 1;
+    *symbol_count = total;
+    return 0;
+}
+
+/**
+ * @brief Troca o indice do primeiro simbolo de cada coluna (column_offset, como calculado por
+ * setup_columns()) pelo byte correspondente no arquivo com separadores.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int Mesmo retorno de scan_file().
+ */
+static int locate_grouped_columns(adfgvx_decipher_stream *stream)
+{
+    int64_t targets[MAX_KEY_LENGTH] = {0}, offsets[MAX_KEY_LENGTH];
+    int columns[MAX_KEY_LENGTH];
+    int target_count = 0;
+    int64_t symbol_count;
+
+    // Insere as colunas nao vazias em ordem crescente de posicao no texto cifrado.
+    for (int col = 0; col < stream->key_length; col++)
+    {
+        if (stream->column_remaining[col] <= 0)
+            continue;
+        int i = target_count++;
+        while (i > 0 && targets[i - 1] > stream->column_offset[col])
+        {
+            targets[i] = targets[i - 1];
+            columns[i] = columns[i - 1];
+            i--;
+        }
+        targets[i] = stream->column_offset[col];
+        columns[i] = col;
+    }
+
+    int status = scan_file(stream, targets, offsets, target_count, &symbol_count);
+    if (status != 0)
+        return status;
+    for (int i = 0; i < target_count; i++)
+        stream->column_offset[columns[i]] = offsets[i];
+    return 0;
+}
+
+int adfgvx_stream_open_file(adfgvx_decipher_stream *stream, const char *filename, const char *key, int key_length)
+{
+    int64_t length;
+    int last;
+
+    if (stream == NULL)
+        return 2;
+    // column_buffer nao precisa ser zerado; evita tocar key_length * ADFGVX_STREAM_COLUMN_BUFFER bytes.
+    memset(stream, 0, offsetof(adfgvx_decipher_stream, column_buffer));
+
+    stream->file = fopen(filename, "rb");
+    if (stream->file == NULL)
+        return 1;
+
+    if (file_seek_64(stream->file, 0, SEEK_END) != 0 || (length = file_tell_64(stream->file)) < 0)
+    {
+        adfgvx_stream_close(stream);
+        return 1;
+    }
+
+    // Ignora a quebra de linha final, assim como read_file().
+    while (length > 0)
+    {
+        file_seek_64(stream->file, length - 1, SEEK_SET);
+        last = fgetc(stream->file);
+        if (last != '\n' && last != '\r')
+            break;
+        length--;
+    }
+
+    // O comprimento das colunas vem da contagem de simbolos, e nao do tamanho do arquivo.
+    int status = scan_file(stream, NULL, NULL, 0, &stream->total_symbols);
+    if (status == 0)
+    {
+        // Com separadores no meio do texto (ex.: grupos de 5), cada coluna precisa do seu byte inicial.
+        stream->grouped = stream->total_symbols != length;
+        status = setup_columns(stream, key, key_length);
+        if (status == 0 && stream->grouped)
+            status = locate_grouped_columns(stream);
+    }
+    if (status != 0)
+    {
+        adfgvx_stream_close(stream);
+        return status;
+    }
+    return 0;
+}
+
+int adfgvx_stream_open_memory(adfgvx_decipher_stream *stream, const char *data, int64_t length, const char *key, int key_length)
+{
+    if (stream == NULL)
+        return 2;
+    // column_buffer nao precisa ser zerado; evita tocar key_length * ADFGVX_STREAM_COLUMN_BUFFER bytes.
+    memset(stream, 0, offsetof(adfgvx_decipher_stream, column_buffer));
+
+    if (data == NULL || length < 0)
+        return 2;
+
+    stream->memory = data;
+    stream->total_symbols = length;
+    return setup_columns(stream, key, key_length);
+}
+
+int adfgvx_stream_open_columns(adfgvx_decipher_stream *stream, FILE *const column_files[], int64_t total_symbols,
+                               const char *key, int key_length)
+{
+    if (stream == NULL)
+        return 2;
+    memset(stream, 0, offsetof(adfgvx_decipher_stream, column_buffer));
+
+    if (column_files == NULL || total_symbols < 0 || key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+        return 2;
+    for (int i = 0; i < key_length; i++)
+    {
+        if (column_files[i] == NULL)
+            return 2;
+        stream->column_file[i] = column_files[i];
+    }
+
+    stream->total_symbols = total_symbols;
+    return setup_columns(stream, key, key_length);
+}
+
+int adfgvx_stream_read(adfgvx_decipher_stream *stream, char *output, int output_size)
+{
+    int written = 0;
+
+    // output_size <= 0 e um erro do chamador, e nao o fim da mensagem.
+    if (stream == NULL || output == NULL || output_size <= 0 || stream->status != 0)
+        return -1;
+
+    while (written < output_size && stream->symbols_read < stream->total_symbols)
+    {
+        char row_symbol, col_symbol;
+
+        if (!next_symbol(stream, &row_symbol) || !next_symbol(stream, &col_symbol))
+        {
+            stream->status = 3;
+            break;
+        }
+
+        int c = adfgvx_grid_decode_pair(row_symbol, col_symbol);
+        if (c < 0)
+        {
+            // Par de simbolos invalido: interrompe, como decode_symbols().
+            stream->status = 2;
+            break;
+        }
+        output[written++] = (char)c;
+    }
+
+    if (written == 0 && stream->status != 0)
+        return -1;
+    return written;
+}
+
+void adfgvx_stream_close(adfgvx_decipher_stream *stream)
+{
+    if (stream == NULL)
+        return;
+    if (stream->file != NULL)
+    {
+        fclose(stream->file);
+        stream->file = NULL;
+    }
+    stream->memory = NULL;
+    // Os arquivos de coluna pertencem ao chamador.
+    for (int i = 0; i < MAX_KEY_LENGTH; i++)
+        stream->column_file[i] = NULL;
+}
@@ -0,0 +1,111 @@
+#ifndef ADFGVX_STREAM_H
+#define ADFGVX_STREAM_H
+
+#include <stdint.h> // Para int64_t
+#include <stdio.h>
+#include "cipher_config.h" // Para MAX_KEY_LENGTH
+
+// Numero de simbolos mantidos em memoria por coluna durante a decifragem em fluxo.
+// A memoria residente do leitor e O(key_length * ADFGVX_STREAM_COLUMN_BUFFER),
+// independente do tamanho do texto cifrado.
+#define ADFGVX_STREAM_COLUMN_BUFFER 4096
+
+/**
+ * @brief Estado de uma decifragem ADFGVX em fluxo (pull-based).
+ *
+ * O texto cifrado e a concatenacao das colunas na ordem alfabetica da chave.
+ * Cada coluna original recebe um cursor de leitura proprio (column_offset) e uma
+ * janela de simbolos (window); a sequencia intermediaria e reconstruida linha a
+ * linha consumindo um simbolo de cada coluna, sem nunca carregar o arquivo inteiro.
+ *
+ * As posicoes e contagens sao de 64 bits (int64_t) mesmo onde long tem 32 bits
+ * (ex.: MinGW), para que arquivos maiores que 2 GB possam ser lidos.
+ *
+ * Os campos sao internos ao modulo; o chamador deve usar apenas as funcoes abaixo.
+ */
+typedef struct adfgvx_decipher_stream
+{
+    FILE *file;          // Fonte em arquivo (NULL quando a fonte e memoria ou segmentos por coluna).
+    const char *memory;  // Fonte em memoria (ex.: regiao mapeada com mmap).
+    int64_t data_offset;   // Posicao do primeiro simbolo cifrado na fonte.
+    int64_t total_symbols; // Quantidade total de simbolos cifrados.
+    int64_t symbols_read;  // Simbolos ja consumidos pela reconstrucao linha a linha.
+    int key_length;
+    int next_column;     // Coluna original de onde sai o proximo simbolo.
+    int status;          // 0 = ok, 2 = texto cifrado invalido, 3 = erro de leitura.
+    int grouped;         // 1 se o arquivo tem separadores entre os simbolos (ex.: grupos de 5).
+
+    FILE *column_file[MAX_KEY_LENGTH];     // Segmento de cada coluna original (ver adfgvx_stream_open_columns).
+    int64_t column_offset[MAX_KEY_LENGTH];    // Proximo byte a buscar na fonte, por coluna original.
+    int64_t column_remaining[MAX_KEY_LENGTH]; // Simbolos ainda nao buscados na fonte, por coluna original.
+    const char *window[MAX_KEY_LENGTH];    // Janela atual de simbolos de cada coluna.
+    int window_length[MAX_KEY_LENGTH];
+    int window_pos[MAX_KEY_LENGTH];
+    char column_buffer[MAX_KEY_LENGTH][ADFGVX_STREAM_COLUMN_BUFFER]; // Usado apenas com fonte em arquivo.
+} adfgvx_decipher_stream;
+
+/**
+ * @brief Abre um arquivo cifrado para decifragem em fluxo.
+ *
+ * Aceita o texto linear e o formato em grupos e linhas de write_ciphertext_to_file().
+ * Uma passada de leitura conta os simbolos (com adfgvx_ingest_ciphertext(), que tambem
+ * valida o alfabeto), e os comprimentos das colunas saem dessa contagem. Se houver
+ * separadores entre os simbolos, uma segunda passada localiza o byte onde cada coluna
+ * comeca, e cada janela lida depois e compactada antes do uso.
+ *
+ * @param stream Estado a ser inicializado.
+ * @param filename Caminho para o arquivo com o texto cifrado (linear ou em grupos).
+ * @param key Chave de cifra.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir ou ler o arquivo, 2 se parametros,
+ * caracteres ou comprimento do texto cifrado forem invalidos.
+ */
+int adfgvx_stream_open_file(adfgvx_decipher_stream *stream, const char *filename, const char *key, int key_length);
+
+/**
+ * @brief Abre um bloco de memoria (ex.: arquivo mapeado) para decifragem em fluxo.
+ * O bloco nao precisa ser terminado em nulo e deve permanecer valido ate o fechamento.
+ *
+ * @param stream Estado a ser inicializado.
+ * @param data Inicio do texto cifrado linearizado.
+ * @param length Quantidade de simbolos em data.
+ * @param key Chave de cifra.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @return int 0 em caso de sucesso, 2 se parametros ou comprimento do texto cifrado forem invalidos.
+ */
+int adfgvx_stream_open_memory(adfgvx_decipher_stream *stream, const char *data, int64_t length, const char *key, int key_length);
+
+/**
+ * @brief Abre um texto cifrado armazenado como um segmento por coluna original
+ * (ex.: adfgvx_column_store) para decifragem em fluxo, sem linearizar as colunas.
+ * Os arquivos nao sao fechados por adfgvx_stream_close().
+ *
+ * @param stream Estado a ser inicializado.
+ * @param column_files Um arquivo por coluna original da chave (na ordem da chave, nao alfabetica),
+ * abertos para leitura binaria.
+ * @param total_symbols Quantidade total de simbolos somando todas as colunas.
+ * @param key Chave de cifra.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @return int 0 em caso de sucesso, 2 se parametros ou comprimento do texto cifrado forem invalidos.
+ */
+int adfgvx_stream_open_columns(adfgvx_decipher_stream *stream, FILE *const column_files[], int64_t total_symbols,
+                               const char *key, int key_length);
+
+/**
+ * @brief Decifra o proximo trecho da mensagem.
+ * O buffer de saida NAO e terminado em nulo.
+ *
+ * @param stream Estado aberto por uma das funcoes adfgvx_stream_open_*.
+ * @param output Buffer onde os caracteres decifrados serao escritos.
+ * @param output_size Capacidade de output (em caracteres, maior que zero).
+ * @return int Numero de caracteres escritos; 0 no fim da mensagem; -1 em caso de erro
+ * (parametros invalidos, ou par de simbolos invalido ou falha de leitura, ver stream->status).
+ */
+int adfgvx_stream_read(adfgvx_decipher_stream *stream, char *output, int output_size);
+
+/**
+ * @brief Libera os recursos do fluxo (fecha o arquivo, se houver).
+ */
+void adfgvx_stream_close(adfgvx_decipher_stream *stream);
+
+#endif // ADFGVX_STREAM_H
@@ -0,0 +1,175 @@
+#include "adfgvx_workspace.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Area de trabalho de uma thread, encadeada na lista do pool para as estatisticas.
+ */
+typedef struct pool_entry
+{
+    adfgvx_workspace workspace;
+    struct pool_entry *prev;
+    struct pool_entry *next;
+} pool_entry;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_key;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER; // Protege as variaveis abaixo e a
+                                                               // capacidade das areas do pool.
+static pool_entry *pool_head = NULL;
+static long pool_peak_capacity = 0;
+static long pool_retired_growths = 0; // Realocacoes feitas por threads ja encerradas.
+
+void adfgvx_workspace_init(adfgvx_workspace *workspace, char *buffer, long capacity)
+{
+    memset(workspace, 0, sizeof(*workspace));
+    if (buffer != NULL && capacity > 0)
+    {
+        workspace->base = buffer;
+        workspace->capacity = capacity;
+    }
+}
+
+void adfgvx_workspace_release(adfgvx_workspace *workspace)
+{
+    if (workspace == NULL)
+        return;
+    if (workspace->owns_memory)
+        free(workspace->base);
+    if (workspace->pooled)
+        pthread_mutex_lock(&pool_lock);
+    workspace->base = NULL;
+    workspace->capacity = 0;
+    workspace->used = 0;
+    workspace->owns_memory = 0;
+    if (workspace->pooled)
+        pthread_mutex_unlock(&pool_lock);
+}
+
+void adfgvx_workspace_reset(adfgvx_workspace *workspace)
+{
+    workspace->used = 0;
+}
+
+int adfgvx_workspace_reserve(adfgvx_workspace *workspace, long bytes)
+{
+    if (workspace == NULL || bytes < 0 || workspace->used != 0)
+        return 2;
+    if (bytes <= workspace->capacity)
+        return 0;
+
+    // Memoria do chamador nao pode ser realocada: passa a usar o heap.
+    char *base = workspace->owns_memory ? realloc(workspace->base, (size_t)bytes) : malloc((size_t)bytes);
+    if (base == NULL)
+        return 1;
+    if (workspace->pooled)
+        pthread_mutex_lock(&pool_lock);
+    workspace->base = base;
+    workspace->capacity = bytes;
+    workspace->owns_memory = 1;
+    workspace->growths++;
+    if (workspace->pooled)
+    {
+        if (bytes > pool_peak_capacity)
+            pool_peak_capacity = bytes;
+        pthread_mutex_unlock(&pool_lock);
+    }
+    return 0;
+}
+
+long adfgvx_workspace_region_size(long bytes)
+{
+    return (bytes + ADFGVX_WORKSPACE_ALIGN - 1) / ADFGVX_WORKSPACE_ALIGN * ADFGVX_WORKSPACE_ALIGN;
+}
+
+void *adfgvx_workspace_alloc(adfgvx_workspace *workspace, long bytes)
+{
+    long size = adfgvx_workspace_region_size(bytes);
+
+    if (bytes < 0 || size > workspace->capacity - workspace->used)
+        return NULL;
+
+    void *region = workspace->base + workspace->used;
+    workspace->used += size;
+    if (workspace->used > workspace->peak)
+        workspace->peak = workspace->used;
+    return region;
+}
+
+/**
+ * @brief Destrutor da chave da thread: retira a area do pool e libera sua memoria.
+ * (Funcao auxiliar estatica)
+ */
+static void pool_entry_destroy(void *arg)
+{
+    pool_entry *entry = arg;
+
+    pthread_mutex_lock(&pool_lock);
+    if (entry->prev != NULL)
+        entry->prev->next = entry->next;
+    else
+        pool_head = entry->next;
+    if (entry->next != NULL)
+        entry->next->prev = entry->prev;
+    pool_retired_growths += entry->workspace.growths;
+    pthread_mutex_unlock(&pool_lock);
+
+    entry->workspace.pooled = 0; // Ja fora da lista: libera sem a trava do pool.
+    adfgvx_workspace_release(&entry->workspace);
+    free(entry);
+}
+
+/**
+ * @brief Cria a chave das areas por thread (executada uma unica vez).
+ * (Funcao auxiliar estatica)
+ */
+static void pool_init(void)
+{
+    pthread_key_create(&pool_key, pool_entry_destroy);
+}
+
+adfgvx_workspace *adfgvx_thread_workspace(void)
+{
+    pthread_once(&pool_once, pool_init);
+
+    pool_entry *entry = pthread_getspecific(pool_key);
+    if (entry != NULL)
+        return &entry->workspace;
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL)
+        return NULL;
+    entry->workspace.pooled = 1;
+    if (pthread_setspecific(pool_key, entry) != 0)
+    {
+        free(entry);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    entry->next = pool_head;
+    if (pool_head != NULL)
+        pool_head->prev = entry;
+    pool_head = entry;
+    pthread_mutex_unlock(&pool_lock);
+    return &entry->workspace;
+}
+
+void adfgvx_workspace_pool_stats(adfgvx_workspace_stats *stats)
+{
+    if (stats == NULL)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_lock(&pool_lock);
+    stats->peak_capacity = pool_peak_capacity;
+    stats->growths = pool_retired_growths;
+    for (pool_entry *entry = pool_head; entry != NULL; entry = entry->next)
+    {
+        stats->workspaces++;
+        stats->capacity += entry->workspace.capacity;
+        stats->growths += entry->workspace.growths;
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
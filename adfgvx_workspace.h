@@ -0,0 +1,96 @@
+#ifndef ADFGVX_WORKSPACE_H
+#define ADFGVX_WORKSPACE_H
+
+// Alinhamento (em bytes) de cada regiao entregue por adfgvx_workspace_alloc().
+#define ADFGVX_WORKSPACE_ALIGN 16
+
+/**
+ * @brief Area de trabalho (arena) para os buffers temporarios da cifra.
+ *
+ * O chamador reserva de uma vez o tamanho exato que a operacao precisa
+ * (adfgvx_workspace_reserve()) e depois obtem as regioes com adfgvx_workspace_alloc(), que
+ * apenas avanca um ponteiro. adfgvx_workspace_reset() libera todas as regioes de uma vez,
+ * sem devolver a memoria: chamadas repetidas com entradas do mesmo tamanho ou menores nao
+ * fazem nenhuma alocacao. A memoria pode vir do chamador (adfgvx_workspace_init() com um
+ * buffer) ou do heap, que so e usado quando a reserva passa da capacidade atual.
+ *
+ * Uma area de trabalho nao deve ser usada por duas threads ao mesmo tempo; cada thread tem a
+ * sua em adfgvx_thread_workspace().
+ */
+typedef struct adfgvx_workspace
+{
+    char *base;
+    long capacity;   // Bytes disponiveis em base.
+    long used;       // Bytes entregues desde o ultimo reset.
+    long peak;       // Maior valor de used desde a criacao.
+    long growths;    // Vezes em que a memoria foi (re)alocada no heap.
+    int owns_memory; // 1 se base veio do heap e deve ser liberada.
+    int pooled;      // 1 se pertence ao pool por thread (capacity e growths sao publicados no pool).
+} adfgvx_workspace;
+
+/**
+ * @brief Uso das areas de trabalho de todas as threads (ver adfgvx_workspace_pool_stats()).
+ */
+typedef struct adfgvx_workspace_stats
+{
+    int workspaces;     // Areas de threads ainda ativas.
+    long capacity;      // Soma das capacidades das areas ativas.
+    long peak_capacity; // Maior capacidade que uma area ja atingiu (inclui threads encerradas).
+    long growths;       // Total de (re)alocacoes no heap (inclui threads encerradas).
+} adfgvx_workspace_stats;
+
+/**
+ * @brief Inicializa uma area de trabalho vazia.
+ *
+ * @param workspace Area a inicializar.
+ * @param buffer Memoria do chamador a ser usada primeiro (pode ser NULL).
+ * @param capacity Tamanho de buffer em bytes (0 se buffer for NULL).
+ */
+void adfgvx_workspace_init(adfgvx_workspace *workspace, char *buffer, long capacity);
+
+/**
+ * @brief Libera a memoria obtida do heap (a do chamador nao e tocada) e zera a area.
+ */
+void adfgvx_workspace_release(adfgvx_workspace *workspace);
+
+/**
+ * @brief Descarta todas as regioes entregues, mantendo a memoria para a proxima operacao.
+ */
+void adfgvx_workspace_reset(adfgvx_workspace *workspace);
+
+/**
+ * @brief Garante capacidade para bytes bytes a partir do inicio da area.
+ * So pode ser chamada com a area vazia (logo apos reset), pois pode mover a memoria.
+ *
+ * @return int 0 em caso de sucesso, 1 se faltar memoria, 2 se parametros invalidos ou area em uso.
+ */
+int adfgvx_workspace_reserve(adfgvx_workspace *workspace, long bytes);
+
+/**
+ * @brief Entrega uma regiao de bytes bytes, alinhada a ADFGVX_WORKSPACE_ALIGN. Nao aloca memoria.
+ *
+ * @return void* A regiao (nao inicializada), ou NULL se nao couber na capacidade reservada.
+ */
+void *adfgvx_workspace_alloc(adfgvx_workspace *workspace, long bytes);
+
+/**
+ * @brief Tamanho que uma regiao de bytes bytes ocupa na area (para somar reservas).
+ */
+long adfgvx_workspace_region_size(long bytes);
+
+/**
+ * @brief Area de trabalho da thread atual, criada vazia na primeira chamada e liberada
+ * quando a thread termina. E usada (e reiniciada) por decipher_adfgvx(): regioes obtidas
+ * dela nao sobrevivem a uma chamada dessas funcoes.
+ *
+ * @return adfgvx_workspace* A area, ou NULL se faltar memoria.
+ */
+adfgvx_workspace *adfgvx_thread_workspace(void);
+
+/**
+ * @brief Resume o uso das areas de trabalho por thread. O pico de uso de cada area fica em
+ * adfgvx_workspace.peak, consultado pela propria thread.
+ */
+void adfgvx_workspace_pool_stats(adfgvx_workspace_stats *stats);
+
+#endif // ADFGVX_WORKSPACE_H
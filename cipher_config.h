@@ -7,10 +7,28 @@
 // Define o comprimento máximo da chave (8 caracteres + 1 para o terminador nulo '\0').
 #define MAX_KEY_LENGTH 9
 
+// Lado da matriz da cifra usada por cipher_adfgvx() e decipher_adfgvx():
+// 5 (ADFGX, I/J juntos), 6 (ADFGVX, padrao) ou 8 (ADFGVX estendido, ASCII 0x20-0x5F).
+// Ver adfgvx_grid.h e fractionating_grids.h. Pode ser trocado na compilacao (-DADFGVX_GRID_SIZE=8).
+#ifndef ADFGVX_GRID_SIZE
+#define ADFGVX_GRID_SIZE 6
+#endif
+
+// Formato convencional do texto cifrado gravado em arquivo: grupos de 5 simbolos, 10 por linha.
+#define ADFGVX_GROUP_SIZE 5
+#define ADFGVX_GROUPS_PER_LINE 10
+
 // Nomes de arquivo padrão.
 #define DEFAULT_KEY_FILE "./key.txt"
 #define DEFAULT_MESSAGE_FILE "./message.txt"
 #define DEFAULT_ENCRYPTED_FILE "./encrypted.txt"
 #define DEFAULT_DECRYPTED_FILE_FOR_TEST "./decrypted_test_output.txt" // Para o teste
+#define DEFAULT_PROFILE_FILE "./adfgvx_profile.txt" // Perfil de calibracao do despachante
+#define DEFAULT_PROFILE_FILE_FOR_TEST "./adfgvx_profile_test.txt" // Para o teste
+#define DEFAULT_STORE_PREFIX_FOR_TEST "./store_test" // Prefixo do armazenamento por colunas usado no teste
+#define DEFAULT_PIPELINE_PREFIX_FOR_TEST "./pipeline_test" // Prefixo dos arquivos do teste do pipeline
+#define DEFAULT_GROUPED_FILE_FOR_TEST "./grouped_test_encrypted.txt" // Texto cifrado agrupado do teste de formatacao
+#define DEFAULT_SEARCH_CHECKPOINT_FILE "./adfgvx_search_checkpoint.txt" // Checkpoint do modo --search
+#define DEFAULT_SEARCH_CHECKPOINT_FOR_TEST "./search_test_checkpoint.txt" // Checkpoint do teste da busca distribuida
 
 #endif // CIPHER_CONFIG_H
@@ -1,6 +1,20 @@
+#define _POSIX_C_SOURCE 200809L // Para fseeko/ftello, fileno e fsync
+#define _FILE_OFFSET_BITS 64    // off_t de 64 bits tambem em sistemas de 32 bits
 #include "file_operations.h"
+#include "adfgvx_format.h" // Para adfgvx_ingest_ciphertext, adfgvx_format_ciphertext
 #include <stdio.h>
-#include <string.h> // Para strcspn
+#if defined(_WIN32)
+#include <io.h>      // Para _commit
+#include <windows.h> // Para MoveFileExA
+#else
+#include <fcntl.h>
+#include <sys/types.h> // Para off_t
+#include <unistd.h>
+#endif
+#include <string.h> // Para strcspn, strrchr
+
+// Simbolos formatados por chamada de fwrite em write_ciphertext_to_file().
+#define FORMAT_CHUNK 4096
 
 int read_file(const char *filename, char *buffer, int max_length)
 {
@@ -22,11 +36,72 @@ int read_file(const char *filename, char *buffer, int max_length)
     return 0;
 }
 
+long get_file_size(const char *filename)
+{
+    FILE *file_ptr = fopen(filename, "rb");
+    if (file_ptr == NULL)
+    {
+        return -1;
+    }
+
+    long size = -1;
+    if (fseek(file_ptr, 0, SEEK_END) == 0)
+    {
+        size = ftell(file_ptr);
+    }
+    fclose(file_ptr);
+    return size;
+}
+
+/**
+ * @brief Formata e grava uma parte do texto cifrado.
+ * (Funcao auxiliar estatica)
+ *
+ * @param formatted Buffer com adfgvx_format_size(count, group_size) posicoes.
+ * @return int 0 em caso de sucesso, 1 se erro de escrita.
+ */
+static int write_formatted_part(FILE *output_file_ptr, const char *symbols, long count, long first_symbol,
+                                int group_size, int groups_per_line, char *formatted)
+{
+    long length = adfgvx_format_ciphertext(symbols, count, first_symbol, group_size, groups_per_line, formatted);
+    if (fwrite(formatted, 1, (size_t)length, output_file_ptr) != (size_t)length)
+    {
+        perror("Erro ao escrever no arquivo de saida cifrada");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Encerra um texto cifrado agrupado com quebra de linha e fecha o arquivo.
+ * (Funcao auxiliar estatica)
+ *
+ * @return int 0 em caso de sucesso, 1 se erro de escrita.
+ */
+static int finish_ciphertext_file(FILE *output_file_ptr, long total_symbols, int group_size)
+{
+    int status = 0;
+
+    if (group_size > 0 && total_symbols > 0 && fputc('\n', output_file_ptr) == EOF)
+        status = 1;
+    if (fclose(output_file_ptr) != 0)
+        status = 1;
+    if (status != 0)
+        perror("Erro ao escrever no arquivo de saida cifrada");
+    return status;
+}
+
 int write_encrypted_data_to_file(const char *filename,
                                  int key_length,
                                  char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH],
-                                 int symbols_per_column[])
+                                 int symbols_per_column[],
+                                 int group_size,
+                                 int groups_per_line)
 {
+    // Cada coluna tem no maximo MAX_MESSAGE_LENGTH simbolos (e um separador por simbolo no pior caso).
+    char formatted[MAX_MESSAGE_LENGTH * 2 + 1];
+    long total_symbols = 0;
+
     FILE *output_file_ptr = fopen(filename, "w");
     if (output_file_ptr == NULL)
     {
@@ -36,19 +111,86 @@ int write_encrypted_data_to_file(const char *filename,
 
     for (int i = 0; i < key_length; i++)
     {
-        for (int j = 0; j < symbols_per_column[i]; j++)
+        if (write_formatted_part(output_file_ptr, encoded_symbol_matrix[i], symbols_per_column[i], total_symbols,
+                                 group_size, groups_per_line, formatted) != 0)
         {
-            if (fputc(encoded_symbol_matrix[i][j], output_file_ptr) == EOF)
-            {
-                perror("Erro ao escrever no arquivo de saida cifrada");
-                fclose(output_file_ptr);
-                return 1;
-            }
+            fclose(output_file_ptr);
+            return 1;
         }
+        total_symbols += symbols_per_column[i];
     }
 
-    fclose(output_file_ptr);
-    return 0;
+    return finish_ciphertext_file(output_file_ptr, total_symbols, group_size);
+}
+
+int write_ciphertext_to_file(const char *filename, const char *ciphertext, int group_size, int groups_per_line)
+{
+    char formatted[FORMAT_CHUNK * 2 + 1];
+    long total_symbols = (long)strlen(ciphertext);
+
+    FILE *output_file_ptr = fopen(filename, "w");
+    if (output_file_ptr == NULL)
+    {
+        perror("Erro ao abrir arquivo para escrita da saida cifrada");
+        return 1;
+    }
+
+    for (long first = 0; first < total_symbols; first += FORMAT_CHUNK)
+    {
+        long count = total_symbols - first;
+        if (count > FORMAT_CHUNK)
+            count = FORMAT_CHUNK;
+        if (write_formatted_part(output_file_ptr, ciphertext + first, count, first,
+                                 group_size, groups_per_line, formatted) != 0)
+        {
+            fclose(output_file_ptr);
+            return 1;
+        }
+    }
+
+    return finish_ciphertext_file(output_file_ptr, total_symbols, group_size);
+}
+
+int read_ciphertext_file(const char *filename, char *buffer, int max_length, long *invalid_offset)
+{
+    char raw[FORMAT_CHUNK];
+    long consumed = 0;
+    long length = 0;
+    size_t read_count;
+
+    if (invalid_offset != NULL)
+        *invalid_offset = -1;
+
+    FILE *file_ptr = fopen(filename, "rb");
+    if (file_ptr == NULL)
+    {
+        return 1;
+    }
+
+    // Le em trechos e normaliza cada um no proprio buffer de leitura.
+    while ((read_count = fread(raw, 1, sizeof(raw), file_ptr)) > 0)
+    {
+        long symbol_count, offset;
+        int status = adfgvx_ingest_ciphertext(raw, (long)read_count, raw, &symbol_count, &offset);
+        if (status != 0 || length + symbol_count > max_length - 1)
+        {
+            if (status != 0 && invalid_offset != NULL)
+                *invalid_offset = consumed + offset;
+            fclose(file_ptr);
+            buffer[0] = '\0';
+            return 2;
+        }
+        memcpy(buffer + length, raw, symbol_count);
+        length += symbol_count;
+        consumed += (long)read_count;
+    }
+
+    int read_error = ferror(file_ptr);
+    fclose(file_ptr);
+    buffer[length] = '\0';
+    if (read_error)
+        return 1;
+    return length > 0 ? 0 : 2;
 }
 
 int write_plaintext_to_file(const char *filename, const char *plaintext_message)
@@ -70,3 +212,60 @@ int write_plaintext_to_file(const char *filename, const char *plaintext_message)
     fclose(output_file_ptr);
     return 0; // Sucesso
 }
+
+int file_seek_64(FILE *file, int64_t offset, int whence)
+{
+#if defined(_WIN32)
+    return _fseeki64(file, offset, whence);
+#else
+    return fseeko(file, (off_t)offset, whence);
+#endif
+}
+
+int64_t file_tell_64(FILE *file)
+{
+#if defined(_WIN32)
+    return (int64_t)_ftelli64(file);
+#else
+    return (int64_t)ftello(file);
+#endif
+}
+
+int file_sync(FILE *file)
+{
+    if (fflush(file) != 0)
+        return 1;
+#if defined(_WIN32)
+    return _commit(_fileno(file)) == 0 ? 0 : 1;
+#else
+    return fsync(fileno(file)) == 0 ? 0 : 1;
+#endif
+}
+
+int file_replace(const char *temp_path, const char *path)
+{
+#if defined(_WIN32)
+    // rename() do Windows falha se o destino existir.
+    return MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : 1;
+#else
+    if (rename(temp_path, path) != 0)
+        return 1;
+
+    // Sincroniza o diretorio para que a propria renomeacao sobreviva a uma queda de energia.
+    char directory[FILENAME_MAX];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+        strcpy(directory, ".");
+    else if (slash == path)
+        strcpy(directory, "/");
+    else if (snprintf(directory, sizeof(directory), "%.*s", (int)(slash - path), path) >= (int)sizeof(directory))
+        return 1;
+
+    int fd = open(directory, O_RDONLY);
+    if (fd < 0)
+        return 1;
+    int status = fsync(fd) == 0 ? 0 : 1;
+    close(fd);
+    return status;
+#endif
+}
@@ -1,6 +1,8 @@
 #ifndef FILE_OPERATIONS_H
 #define FILE_OPERATIONS_H
 
+#include <stdint.h> // Para int64_t
+#include <stdio.h>
 #include "cipher_config.h" // Para MAX_MESSAGE_LENGTH
 
 /**
@@ -14,19 +16,57 @@
  */
 int read_file(const char *filename, char *buffer, int max_length);
 
+/**
+ * @brief Retorna o tamanho de um arquivo em bytes, para dimensionar o buffer de leitura.
+ *
+ * @param filename Caminho para o arquivo.
+ * @return long Tamanho em bytes, ou -1 se o arquivo nao puder ser aberto ou medido.
+ */
+long get_file_size(const char *filename);
+
 /**
  * @brief Escreve a matriz de simbolos cifrados em um arquivo.
+ * Os simbolos sao formatados com adfgvx_format_ciphertext() e gravados coluna a coluna com
+ * fwrite, sem chamadas por caractere.
  *
  * @param filename Caminho para o arquivo onde a saida sera escrita.
  * @param key_length Comprimento da chave (que corresponde ao numero de colunas na matriz).
  * @param encoded_symbol_matrix Matriz [key_length][MAX_MESSAGE_LENGTH] contendo os simbolos cifrados.
  * @param symbols_per_column Vetor indicando quantos simbolos validos existem em cada coluna da matriz.
+ * @param group_size Simbolos por grupo (ex.: ADFGVX_GROUP_SIZE; 0 grava o texto linear, sem separadores).
+ * @param groups_per_line Grupos por linha (ex.: ADFGVX_GROUPS_PER_LINE; 0 para uma unica linha).
  * @return int 0 em caso de sucesso, 1 se erro ao abrir ou escrever no arquivo.
  */
 int write_encrypted_data_to_file(const char *filename,
                                  int key_length,
                                  char encoded_symbol_matrix[][MAX_MESSAGE_LENGTH],
-                                 int symbols_per_column[]);
+                                 int symbols_per_column[],
+                                 int group_size,
+                                 int groups_per_line);
+
+/**
+ * @brief Escreve um texto cifrado linear em um arquivo, em grupos e linhas.
+ *
+ * @param filename Caminho para o arquivo onde a saida sera escrita.
+ * @param ciphertext Texto cifrado linear (string terminada em nulo).
+ * @param group_size Simbolos por grupo (0 grava o texto linear, sem separadores).
+ * @param groups_per_line Grupos por linha (0 para uma unica linha).
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir ou escrever no arquivo.
+ */
+int write_ciphertext_to_file(const char *filename, const char *ciphertext, int group_size, int groups_per_line);
+
+/**
+ * @brief Le um arquivo de texto cifrado inteiro (todas as linhas), removendo espacos e quebras
+ * de linha do agrupamento e validando o alfabeto (ver adfgvx_ingest_ciphertext()).
+ *
+ * @param filename Caminho para o arquivo a ser lido.
+ * @param buffer Buffer onde os simbolos serao armazenados (terminado em nulo).
+ * @param max_length Tamanho do buffer (incluindo espaco para '\0').
+ * @param invalid_offset Posicao no arquivo do primeiro caractere invalido, ou -1 (pode ser NULL).
+ * @return int 0 em caso de sucesso, 1 se erro ao abrir ou ler o arquivo, 2 se o arquivo tiver
+ * caractere invalido, nenhum simbolo ou mais simbolos do que cabem no buffer.
+ */
+int read_ciphertext_file(const char *filename, char *buffer, int max_length, long *invalid_offset);
 
 /**
  * @brief Escreve uma string de texto plano (como a mensagem decifrada) em um arquivo.
@@ -37,4 +77,34 @@ int write_encrypted_data_to_file(const char *filename,
  */
 int write_plaintext_to_file(const char *filename, const char *plaintext_message);
 
+/**
+ * @brief Posiciona um arquivo em um deslocamento de 64 bits a partir de whence.
+ * fseek() usa long, que tem 32 bits no MinGW e limitaria os arquivos a 2 GB.
+ *
+ * @return int 0 em caso de sucesso.
+ */
+int file_seek_64(FILE *file, int64_t offset, int whence);
+
+/**
+ * @brief Posicao atual de um arquivo (64 bits), ou -1 em caso de erro.
+ */
+int64_t file_tell_64(FILE *file);
+
+/**
+ * @brief Descarrega um arquivo ate o disco (fflush e fsync, ou _commit no Windows), e nao
+ * apenas ate o sistema operacional.
+ *
+ * @return int 0 em caso de sucesso, 1 se erro.
+ */
+int file_sync(FILE *file);
+
+/**
+ * @brief Substitui path por temp_path de forma atomica: quem ler path ve o arquivo antigo ou o
+ * novo, nunca um arquivo truncado. O diretorio tambem e sincronizado, para que a propria troca
+ * sobreviva a uma queda de energia. temp_path deve ter sido fechado depois de file_sync().
+ *
+ * @return int 0 em caso de sucesso, 1 se erro.
+ */
+int file_replace(const char *temp_path, const char *path);
+
 #endif // FILE_OPERATIONS_H
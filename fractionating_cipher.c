@@ -0,0 +1,147 @@
+#include "fractionating_cipher.h"
+#include "adfgvx_core.h" // Para adfgvx_key_order
+#include "fractionating_grids.h"
+#include <string.h>
+
+// Numero de caracteres substituidos por vez (buffer de simbolos na pilha).
+#define CHUNK_CHARS 512
+
+// Nucleo ADFGX 5x5: frac_adfgx_*().
+#define FRAC_PREFIX frac_adfgx
+#define FRAC_GRID_SIZE FRACTIONATING_ADFGX_GRID_SIZE
+#define FRAC_SYMBOLS FRACTIONATING_ADFGX_SYMBOLS
+#define FRAC_CELLS FRACTIONATING_ADFGX_CELLS
+#define FRAC_ALIASES FRACTIONATING_ADFGX_ALIASES
+#include "fractionating_kernel.h"
+
+// Nucleo ADFGVX 6x6: frac_adfgvx_*().
+#define FRAC_PREFIX frac_adfgvx
+#define FRAC_GRID_SIZE FRACTIONATING_ADFGVX_GRID_SIZE
+#define FRAC_SYMBOLS FRACTIONATING_ADFGVX_SYMBOLS
+#define FRAC_CELLS FRACTIONATING_ADFGVX_CELLS
+#define FRAC_ALIASES FRACTIONATING_ADFGVX_ALIASES
+#include "fractionating_kernel.h"
+
+// Nucleo ADFGVX 8x8: frac_adfgvx8_*().
+#define FRAC_PREFIX frac_adfgvx8
+#define FRAC_GRID_SIZE FRACTIONATING_ADFGVX8_GRID_SIZE
+#define FRAC_SYMBOLS FRACTIONATING_ADFGVX8_SYMBOLS
+#define FRAC_CELLS FRACTIONATING_ADFGVX8_CELLS
+#define FRAC_ALIASES FRACTIONATING_ADFGVX8_ALIASES
+#include "fractionating_kernel.h"
+
+const fractionating_variant FRACTIONATING_ADFGX = {
+    "ADFGX", FRACTIONATING_ADFGX_GRID_SIZE, frac_adfgx_symbols, frac_adfgx_substitute, frac_adfgx_unsubstitute};
+const fractionating_variant FRACTIONATING_ADFGVX = {
+    "ADFGVX", FRACTIONATING_ADFGVX_GRID_SIZE, frac_adfgvx_symbols, frac_adfgvx_substitute, frac_adfgvx_unsubstitute};
+const fractionating_variant FRACTIONATING_ADFGVX8 = {
+    "ADFGVX8", FRACTIONATING_ADFGVX8_GRID_SIZE, frac_adfgvx8_symbols, frac_adfgvx8_substitute, frac_adfgvx8_unsubstitute};
+
+/**
+ * @brief Calcula o inicio de cada coluna original no texto cifrado linear.
+ * (Funcao auxiliar estatica)
+ *
+ * A coluna original c tem rows + (c < extra) simbolos, e as colunas aparecem na ordem
+ * alfabetica estavel da chave (adfgvx_key_order()).
+ */
+static void compute_column_starts(const char *key, int key_length, long symbol_count, long column_start[])
+{
+    int order[MAX_KEY_LENGTH];
+    long pos = 0;
+
+    adfgvx_key_order(key, key_length, order);
+
+    for (int i = 0; i < key_length; i++)
+    {
+        int c = order[i];
+        column_start[c] = pos;
+        pos += symbol_count / key_length + (c < symbol_count % key_length ? 1 : 0);
+    }
+}
+
+int fractionating_encrypt(const fractionating_variant *variant, const char *key, int key_length,
+                          const char *message, char *output, long output_size)
+{
+    char chunk[2 * CHUNK_CHARS];
+    long column_start[MAX_KEY_LENGTH];
+    long symbol_count = 0, length;
+
+    if (variant == NULL || key == NULL || message == NULL || output == NULL || output_size <= 0 ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        return 2;
+    }
+    length = (long)strlen(message);
+
+    // 1) Conta os simbolos para posicionar as colunas.
+    for (long start = 0; start < length; start += CHUNK_CHARS)
+    {
+        long n = length - start < CHUNK_CHARS ? length - start : CHUNK_CHARS;
+        symbol_count += variant->substitute(message + start, n, chunk);
+    }
+    if (symbol_count >= output_size)
+    {
+        output[0] = '\0';
+        return 1;
+    }
+
+    // 2) Substitui novamente e escreve cada simbolo na sua posicao final.
+    compute_column_starts(key, key_length, symbol_count, column_start);
+    long row = 0;
+    int col = 0;
+    for (long start = 0; start < length; start += CHUNK_CHARS)
+    {
+        long n = length - start < CHUNK_CHARS ? length - start : CHUNK_CHARS;
+        long produced = variant->substitute(message + start, n, chunk);
+        for (long s = 0; s < produced; s++)
+        {
+            output[column_start[col] + row] = chunk[s];
+            if (++col == key_length)
+            {
+                col = 0;
+                row++;
+            }
+        }
+    }
+    output[symbol_count] = '\0';
+    return 0;
+}
+
+int fractionating_decrypt(const fractionating_variant *variant, const char *ciphertext, const char *key,
+                          int key_length, char *output, long output_size)
+{
+    char chunk[2 * CHUNK_CHARS];
+    long column_start[MAX_KEY_LENGTH];
+    long symbol_count, written = 0;
+
+    if (variant == NULL || ciphertext == NULL || key == NULL || output == NULL || output_size <= 0 ||
+        key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        return 2;
+    }
+    output[0] = '\0';
+
+    symbol_count = (long)strlen(ciphertext);
+    if (symbol_count % 2 != 0)
+        return 0; // Nao pode decodificar numero impar de simbolos
+    if (symbol_count / 2 >= output_size)
+        return 1;
+
+    compute_column_starts(key, key_length, symbol_count, column_start);
+
+    // Le a sequencia intermediaria linha a linha e decodifica em blocos.
+    long next = 0;
+    while (next < symbol_count)
+    {
+        long n = symbol_count - next < 2 * CHUNK_CHARS ? symbol_count - next : 2 * CHUNK_CHARS;
+        for (long s = 0; s < n; s++, next++)
+            chunk[s] = ciphertext[column_start[next % key_length] + next / key_length];
+
+        long decoded = variant->unsubstitute(chunk, n, output + written);
+        written += decoded;
+        if (decoded < n / 2)
+            break; // Par de simbolos invalido
+    }
+    output[written] = '\0';
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef FRACTIONATING_CIPHER_H
+#define FRACTIONATING_CIPHER_H
+
+#include "cipher_config.h" // Para MAX_KEY_LENGTH
+
+/**
+ * @brief Uma variante da familia de cifras fracionadas (matriz + alfabeto de simbolos).
+ *
+ * Os nucleos substitute/unsubstitute sao gerados por fractionating_kernel.h especificamente
+ * para cada matriz; a escolha da variante acontece uma vez por chamada, nunca por caractere.
+ */
+typedef struct fractionating_variant
+{
+    const char *name;
+    int grid_size;
+    const char *symbols; // grid_size simbolos (nao terminado em nulo)
+
+    // Texto -> pares de simbolos; ignora caracteres fora da matriz. Retorna o numero de simbolos.
+    long (*substitute)(const char *text, long length, char *out);
+    // Pares de simbolos -> texto; para no primeiro par invalido. Retorna o numero de caracteres.
+    long (*unsubstitute)(const char *pairs, long symbol_count, char *out);
+} fractionating_variant;
+
+// ADFGX classico, matriz 5x5 com I/J na mesma celula.
+extern const fractionating_variant FRACTIONATING_ADFGX;
+// ADFGVX 6x6, a mesma matriz de cipher_adfgvx() (com ADFGVX_GRID_SIZE padrao).
+extern const fractionating_variant FRACTIONATING_ADFGVX;
+// ADFGVX estendido 8x8, ASCII de 0x20 a 0x5F (minusculas cifradas como maiusculas).
+extern const fractionating_variant FRACTIONATING_ADFGVX8;
+
+/**
+ * @brief Cifra uma mensagem com a variante indicada e transposicao colunar pela chave.
+ * O texto cifrado linear e o mesmo formato produzido por cipher_adfgvx() + leitura das colunas.
+ *
+ * @param variant Variante da cifra.
+ * @param key Chave de transposicao.
+ * @param key_length Comprimento da chave (1 a MAX_KEY_LENGTH - 1).
+ * @param message Mensagem (string terminada em nulo).
+ * @param output Buffer para o texto cifrado (terminado em nulo).
+ * @param output_size Capacidade de output (2 * strlen(message) + 1 sempre basta).
+ * @return int 0 em caso de sucesso, 1 se output for pequeno demais, 2 se parametros invalidos.
+ */
+int fractionating_encrypt(const fractionating_variant *variant, const char *key, int key_length,
+                          const char *message, char *output, long output_size);
+
+/**
+ * @brief Decifra um texto produzido por fractionating_encrypt() com a mesma variante e chave.
+ * Para no primeiro par de simbolos invalido; texto com numero impar de simbolos gera saida vazia.
+ *
+ * @param output Buffer para a mensagem (terminada em nulo).
+ * @param output_size Capacidade de output (strlen(ciphertext) / 2 + 1 sempre basta).
+ * @return int 0 em caso de sucesso, 1 se output for pequeno demais, 2 se parametros invalidos.
+ */
+int fractionating_decrypt(const fractionating_variant *variant, const char *ciphertext, const char *key,
+                          int key_length, char *output, long output_size);
+
+#endif // FRACTIONATING_CIPHER_H
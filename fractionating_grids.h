@@ -0,0 +1,56 @@
+#ifndef FRACTIONATING_GRIDS_H
+#define FRACTIONATING_GRIDS_H
+
+// Definicao das matrizes das cifras fracionadas suportadas, como listas X-macro.
+// Cada entrada X(caractere, linha, coluna) posiciona um caractere na matriz; as listas
+// *_ALIASES mapeiam caracteres extras para celulas ja ocupadas (apenas na cifragem).
+// Essas listas sao expandidas em tabelas constantes por fractionating_kernel.h.
+
+// ADFGX classico: matriz 5x5, com I e J na mesma celula.
+#define FRACTIONATING_ADFGX_GRID_SIZE 5
+#define FRACTIONATING_ADFGX_SYMBOLS(X) \
+    X('A', 0) X('D', 1) X('F', 2) X('G', 3) X('X', 4)
+#define FRACTIONATING_ADFGX_CELLS(X) \
+    X('A', 0, 0) X('B', 0, 1) X('C', 0, 2) X('D', 0, 3) X('E', 0, 4) \
+    X('F', 1, 0) X('G', 1, 1) X('H', 1, 2) X('I', 1, 3) X('K', 1, 4) \
+    X('L', 2, 0) X('M', 2, 1) X('N', 2, 2) X('O', 2, 3) X('P', 2, 4) \
+    X('Q', 3, 0) X('R', 3, 1) X('S', 3, 2) X('T', 3, 3) X('U', 3, 4) \
+    X('V', 4, 0) X('W', 4, 1) X('X', 4, 2) X('Y', 4, 3) X('Z', 4, 4)
+#define FRACTIONATING_ADFGX_ALIASES(X) \
+    X('J', 1, 3)
+
+// ADFGVX: matriz 6x6 original deste projeto (letras, espaco, virgula, ponto e digitos 1-7).
+#define FRACTIONATING_ADFGVX_GRID_SIZE 6
+#define FRACTIONATING_ADFGVX_SYMBOLS(X) \
+    X('A', 0) X('D', 1) X('F', 2) X('G', 3) X('V', 4) X('X', 5)
+#define FRACTIONATING_ADFGVX_CELLS(X) \
+    X('A', 0, 0) X('B', 0, 1) X('C', 0, 2) X('D', 0, 3) X('E', 0, 4) X('F', 0, 5) \
+    X('G', 1, 0) X('H', 1, 1) X('I', 1, 2) X('J', 1, 3) X('K', 1, 4) X('L', 1, 5) \
+    X('M', 2, 0) X('N', 2, 1) X('O', 2, 2) X('P', 2, 3) X('Q', 2, 4) X('R', 2, 5) \
+    X('S', 3, 0) X('T', 3, 1) X('U', 3, 2) X('V', 3, 3) X('W', 3, 4) X('X', 3, 5) \
+    X('Y', 4, 0) X('Z', 4, 1) X(' ', 4, 2) X(',', 4, 3) X('.', 4, 4) X('1', 4, 5) \
+    X('2', 5, 0) X('3', 5, 1) X('4', 5, 2) X('5', 5, 3) X('6', 5, 4) X('7', 5, 5)
+#define FRACTIONATING_ADFGVX_ALIASES(X)
+
+// ADFGVX estendido 8x8: os 64 caracteres ASCII de 0x20 (espaco) a 0x5F ('_'), com as
+// letras minusculas cifradas como maiusculas. '`', '{', '|', '}' e '~' nao cabem na matriz.
+#define FRACTIONATING_ADFGVX8_GRID_SIZE 8
+#define FRACTIONATING_ADFGVX8_SYMBOLS(X) \
+    X('A', 0) X('D', 1) X('F', 2) X('G', 3) X('K', 4) X('M', 5) X('V', 6) X('X', 7)
+#define FRACTIONATING_ADFGVX8_CELLS(X) \
+    X(' ', 0, 0) X('!', 0, 1) X('"', 0, 2) X('#', 0, 3) X('$', 0, 4) X('%', 0, 5) X('&', 0, 6) X('\'', 0, 7) \
+    X('(', 1, 0) X(')', 1, 1) X('*', 1, 2) X('+', 1, 3) X(',', 1, 4) X('-', 1, 5) X('.', 1, 6) X('/', 1, 7) \
+    X('0', 2, 0) X('1', 2, 1) X('2', 2, 2) X('3', 2, 3) X('4', 2, 4) X('5', 2, 5) X('6', 2, 6) X('7', 2, 7) \
+    X('8', 3, 0) X('9', 3, 1) X(':', 3, 2) X(';', 3, 3) X('<', 3, 4) X('=', 3, 5) X('>', 3, 6) X('?', 3, 7) \
+    X('@', 4, 0) X('A', 4, 1) X('B', 4, 2) X('C', 4, 3) X('D', 4, 4) X('E', 4, 5) X('F', 4, 6) X('G', 4, 7) \
+    X('H', 5, 0) X('I', 5, 1) X('J', 5, 2) X('K', 5, 3) X('L', 5, 4) X('M', 5, 5) X('N', 5, 6) X('O', 5, 7) \
+    X('P', 6, 0) X('Q', 6, 1) X('R', 6, 2) X('S', 6, 3) X('T', 6, 4) X('U', 6, 5) X('V', 6, 6) X('W', 6, 7) \
+    X('X', 7, 0) X('Y', 7, 1) X('Z', 7, 2) X('[', 7, 3) X('\\', 7, 4) X(']', 7, 5) X('^', 7, 6) X('_', 7, 7)
+#define FRACTIONATING_ADFGVX8_ALIASES(X) \
+    X('a', 4, 1) X('b', 4, 2) X('c', 4, 3) X('d', 4, 4) X('e', 4, 5) X('f', 4, 6) \
+    X('g', 4, 7) X('h', 5, 0) X('i', 5, 1) X('j', 5, 2) X('k', 5, 3) X('l', 5, 4) \
+    X('m', 5, 5) X('n', 5, 6) X('o', 5, 7) X('p', 6, 0) X('q', 6, 1) X('r', 6, 2) \
+    X('s', 6, 3) X('t', 6, 4) X('u', 6, 5) X('v', 6, 6) X('w', 6, 7) X('x', 7, 0) \
+    X('y', 7, 1) X('z', 7, 2)
+
+#endif // FRACTIONATING_GRIDS_H
@@ -0,0 +1,141 @@
+// Modelo de nucleo de substituicao para uma cifra fracionada (sem include guard de proposito).
+//
+// Antes de incluir este arquivo, defina:
+//   FRAC_PREFIX     prefixo dos nomes gerados (ex.: adfgvx_grid -> adfgvx_grid_encode_char)
+//   FRAC_GRID_SIZE  lado da matriz (5, 6 ou 8)
+//   FRAC_SYMBOLS    lista X-macro X(simbolo, indice)
+//   FRAC_CELLS      lista X-macro X(caractere, linha, coluna)
+//   FRAC_ALIASES    (opcional) lista X-macro de caracteres extras X(caractere, linha, coluna)
+//
+// Cada inclusao gera tabelas constantes de 256 posicoes e funcoes static inline especializadas
+// para aquela matriz: o tamanho da matriz e constante em tempo de compilacao e nenhum laco
+// quente precisa testar qual variante esta em uso. Ver fractionating_grids.h.
+
+#if !defined(FRAC_PREFIX) || !defined(FRAC_GRID_SIZE) || !defined(FRAC_SYMBOLS) || !defined(FRAC_CELLS)
+#error "Defina FRAC_PREFIX, FRAC_GRID_SIZE, FRAC_SYMBOLS e FRAC_CELLS antes de incluir fractionating_kernel.h"
+#endif
+
+#ifndef FRAC_ALIASES
+#define FRAC_ALIASES(X)
+#endif
+
+#define FRAC_JOIN2(a, b) a##_##b
+#define FRAC_JOIN(a, b) FRAC_JOIN2(a, b)
+#define FRAC_NAME(name) FRAC_JOIN(FRAC_PREFIX, name)
+
+// As tabelas guardam indice + 1, para que as posicoes nao listadas (zero) signifiquem "invalido".
+#define FRAC_CELL_ENTRY(ch, r, c) [(unsigned char)(ch)] = (unsigned char)((r) * FRAC_GRID_SIZE + (c) + 1),
+#define FRAC_SQUARE_ENTRY(ch, r, c) [(r) * FRAC_GRID_SIZE + (c)] = (ch),
+#define FRAC_SYMBOL_ENTRY(sym, i) [(unsigned char)(sym)] = (unsigned char)((i) + 1),
+#define FRAC_SYMBOL_CHAR(sym, i) [(i)] = (sym),
+
+// Caractere -> celula (linha * FRAC_GRID_SIZE + coluna) + 1.
+static const unsigned char FRAC_NAME(cell_table)[256] = {FRAC_CELLS(FRAC_CELL_ENTRY) FRAC_ALIASES(FRAC_CELL_ENTRY)};
+
+// Celula -> caractere.
+static const char FRAC_NAME(square)[FRAC_GRID_SIZE * FRAC_GRID_SIZE] = {FRAC_CELLS(FRAC_SQUARE_ENTRY)};
+
+// Simbolo -> indice + 1, e indice -> simbolo.
+static const unsigned char FRAC_NAME(symbol_table)[256] = {FRAC_SYMBOLS(FRAC_SYMBOL_ENTRY)};
+static const char FRAC_NAME(symbols)[FRAC_GRID_SIZE] = {FRAC_SYMBOLS(FRAC_SYMBOL_CHAR)};
+
+/**
+ * @brief Retorna a celula de um caractere na matriz, ou -1 se ele nao estiver na matriz.
+ */
+static inline int FRAC_NAME(cell)(char c)
+{
+    return (int)FRAC_NAME(cell_table)[(unsigned char)c] - 1;
+}
+
+/**
+ * @brief Retorna o indice de um simbolo no alfabeto da cifra, ou -1 se ele nao pertencer ao alfabeto.
+ */
+static inline int FRAC_NAME(symbol_index)(char s)
+{
+    return (int)FRAC_NAME(symbol_table)[(unsigned char)s] - 1;
+}
+
+/**
+ * @brief Encontra os simbolos de linha e coluna correspondentes a um caractere.
+ *
+ * @return int Retorna 1 se o caractere foi encontrado, 0 caso contrario.
+ */
+static inline int FRAC_NAME(encode_char)(char c, char *row, char *col)
+{
+    int cell = FRAC_NAME(cell)(c);
+    if (cell < 0)
+        return 0;
+    *row = FRAC_NAME(symbols)[cell / FRAC_GRID_SIZE];
+    *col = FRAC_NAME(symbols)[cell % FRAC_GRID_SIZE];
+    return 1;
+}
+
+/**
+ * @brief Converte um par de simbolos (linha, coluna) no caractere da matriz.
+ *
+ * @return int O caractere (como unsigned char), ou -1 se algum simbolo for invalido.
+ */
+static inline int FRAC_NAME(decode_pair)(char row_symbol, char col_symbol)
+{
+    int row = FRAC_NAME(symbol_index)(row_symbol);
+    int col = FRAC_NAME(symbol_index)(col_symbol);
+    if (row < 0 || col < 0)
+        return -1;
+    return (unsigned char)FRAC_NAME(square)[row * FRAC_GRID_SIZE + col];
+}
+
+/**
+ * @brief Substitui um trecho de texto pela sequencia de pares de simbolos.
+ * Caracteres fora da matriz sao ignorados.
+ *
+ * @param out Saida com pelo menos 2 * length posicoes.
+ * @return long Numero de simbolos escritos em out.
+ */
+static inline long FRAC_NAME(substitute)(const char *text, long length, char *out)
+{
+    long n = 0;
+    for (long i = 0; i < length; i++)
+    {
+        int cell = FRAC_NAME(cell)(text[i]);
+        if (cell < 0)
+            continue;
+        out[n] = FRAC_NAME(symbols)[cell / FRAC_GRID_SIZE];
+        out[n + 1] = FRAC_NAME(symbols)[cell % FRAC_GRID_SIZE];
+        n += 2;
+    }
+    return n;
+}
+
+/**
+ * @brief Converte uma sequencia de pares de simbolos de volta em texto.
+ * Para no primeiro par invalido, como decode_symbols() em adfgvx_decipher.c.
+ *
+ * @param symbol_count Numero de simbolos em pairs (deve ser par).
+ * @param out Saida com pelo menos symbol_count / 2 posicoes (nao terminada em nulo).
+ * @return long Numero de caracteres escritos; se menor que symbol_count / 2, houve par invalido.
+ */
+static inline long FRAC_NAME(unsubstitute)(const char *pairs, long symbol_count, char *out)
+{
+    long n = 0;
+    for (long i = 0; i + 1 < symbol_count; i += 2)
+    {
+        int c = FRAC_NAME(decode_pair)(pairs[i], pairs[i + 1]);
+        if (c < 0)
+            break;
+        out[n++] = (char)c;
+    }
+    return n;
+}
+
+#undef FRAC_CELL_ENTRY
+#undef FRAC_SQUARE_ENTRY
+#undef FRAC_SYMBOL_ENTRY
+#undef FRAC_SYMBOL_CHAR
+#undef FRAC_NAME
+#undef FRAC_JOIN
+#undef FRAC_JOIN2
+#undef FRAC_ALIASES
+#undef FRAC_CELLS
+#undef FRAC_SYMBOLS
+#undef FRAC_GRID_SIZE
+#undef FRAC_PREFIX
@@ -1,27 +1,141 @@
 #include <stdio.h>
 #include <string.h> // Para strlen
 #include <stdlib.h> // Para EXIT_FAILURE, EXIT_SUCCESS (ou pode usar 0 e 1 diretamente)
+#include <limits.h> // Para INT_MAX
 
 // Inclui os novos arquivos de cabealho dos mdulos
 #include "cipher_config.h"
 #include "file_operations.h"
-#include "adfgvx_core.h"
+#include "adfgvx_dispatch.h"
+#include "adfgvx_pipeline.h"
+#include "adfgvx_workspace.h"
+#include "adfgvx_shard.h"
+#include "adfgvx_decipher.h"
+
+/**
+ * @brief Modo --search: busca distribuida da chave do texto cifrado em DEFAULT_ENCRYPTED_FILE.
+ * (Funcao auxiliar estatica)
+ *
+ * @param key_length Comprimento da chave a testar.
+ * @return int EXIT_SUCCESS se a busca terminou, EXIT_FAILURE caso contrario.
+ */
+static int run_key_search(int key_length)
+{
+    if (key_length <= 0 || key_length >= MAX_KEY_LENGTH)
+    {
+        fprintf(stderr, "Uso: --search <comprimento da chave, de 1 a %d>\n", MAX_KEY_LENGTH - 1);
+        return EXIT_FAILURE;
+    }
+
+    // Texto cifrado em uma area de trabalho dimensionada pelo arquivo.
+    long file_size = get_file_size(DEFAULT_ENCRYPTED_FILE);
+    int capacity = file_size >= 0 && file_size < MAX_MESSAGE_LENGTH * 2 ? (int)file_size + 1 : MAX_MESSAGE_LENGTH * 2 + 1;
+    adfgvx_workspace workspace;
+    adfgvx_workspace_init(&workspace, NULL, 0);
+    if (adfgvx_workspace_reserve(&workspace, adfgvx_workspace_region_size(capacity)) != 0)
+    {
+        fprintf(stderr, "Memoria insuficiente para o texto cifrado.\n");
+        return EXIT_FAILURE;
+    }
+    char *ciphertext = adfgvx_workspace_alloc(&workspace, capacity);
+
+    long invalid_offset;
+    int status = read_ciphertext_file(DEFAULT_ENCRYPTED_FILE, ciphertext, capacity, &invalid_offset);
+    if (status != 0)
+    {
+        if (invalid_offset >= 0)
+            fprintf(stderr, "Caractere invalido na posicao %ld do arquivo cifrado.\n", invalid_offset);
+        fprintf(stderr, "Erro lendo arquivo cifrado '%s'. Codigo: %d\n", DEFAULT_ENCRYPTED_FILE, status);
+        adfgvx_workspace_release(&workspace);
+        return EXIT_FAILURE;
+    }
+
+    adfgvx_shard_config config;
+    adfgvx_shard_report report;
+    config.ciphertext = ciphertext;
+    config.key_length = key_length;
+    config.shard_size = ADFGVX_SHARD_SIZE;
+    config.worker_count = ADFGVX_SHARD_WORKERS;
+    config.top_n = 10;
+    config.checkpoint_file = DEFAULT_SEARCH_CHECKPOINT_FILE;
+    config.max_shards = 0;
+
+    printf("Buscando chaves de %d caracteres em '%s' (checkpoint em '%s')...\n",
+           key_length, DEFAULT_ENCRYPTED_FILE, DEFAULT_SEARCH_CHECKPOINT_FILE);
+    status = adfgvx_shard_search(&config, &report);
+    if (status == 2)
+    {
+        // Rodar de novo nao adianta: o checkpoint continuaria sendo recusado.
+        fprintf(stderr, "O checkpoint '%s' e de outro texto cifrado ou de outro comprimento de chave. "
+                        "Apague o arquivo para recomecar a busca.\n", DEFAULT_SEARCH_CHECKPOINT_FILE);
+        adfgvx_workspace_release(&workspace);
+        return EXIT_FAILURE;
+    }
+    if (status != 0)
+    {
+        fprintf(stderr, "Falha na busca distribuida (codigo %d). Rode novamente para continuar do checkpoint.\n", status);
+        adfgvx_workspace_release(&workspace);
+        return EXIT_FAILURE;
+    }
+
+    printf("Shards: %ld de %ld (%ld retomados do checkpoint), %ld ordenacoes em %.3fs (%.0f/s)\n",
+           report.shards_done, report.shard_count, report.shards_resumed, report.orderings_evaluated,
+           report.elapsed_seconds, report.orderings_per_second);
+    for (int r = 0; r < report.result_count; r++)
+    {
+        char plaintext[MAX_MESSAGE_LENGTH];
+        decipher_adfgvx(ciphertext, report.results[r].key, key_length, plaintext);
+        printf("%2d. chave equivalente \"%s\", pontuacao %.4f: \"%.50s%s\"\n", r + 1, report.results[r].key,
+               report.results[r].score, plaintext, strlen(plaintext) > 50 ? "..." : "");
+    }
+    adfgvx_workspace_release(&workspace);
+    return EXIT_SUCCESS;
+}
 
 /**
  * @brief Funcao principal do programa de cifragem ADFGVX.
  * (Mantendo a documentacao original da funcao main)
+ *
+ * Com o argumento --calibrate, mede as implementacoes disponiveis nesta maquina,
+ * salva o perfil em DEFAULT_PROFILE_FILE e encerra.
+ * Com o argumento --pipeline, cifra todo o DEFAULT_MESSAGE_FILE (de qualquer tamanho)
+ * sobrepondo leitura, calculo e escrita (ver adfgvx_pipeline.h).
+ * Com os argumentos --search <comprimento>, procura a chave de DEFAULT_ENCRYPTED_FILE testando
+ * todas as ordenacoes da transposicao em varios processos, com checkpoint em
+ * DEFAULT_SEARCH_CHECKPOINT_FILE: se interrompida, a busca continua de onde parou
+ * (ver adfgvx_shard.h).
  */
-int main()
+int main(int argc, char *argv[])
 {
-    // Variaveis para armazenar a chave e a mensagem lidas dos arquivos.
-    char cipher_key_buffer[MAX_KEY_LENGTH]; // Renomeado de cipher_key
-    char message_buffer[MAX_MESSAGE_LENGTH]; // Renomeado de message
+    // Perfil usado pelo despachante para escolher a implementacao mais rapida.
+    adfgvx_profile profile;
 
-    // Contador de simbolos ADFGVX por coluna.
-    // Inicializado com zeros. O tamanho MAX_KEY_LENGTH  usado aqui pois
-    // o comprimento real da chave (actual_key_length) ainda nao  conhecido.
-    // Apenas as posicoes ate actual_key_length-1 serao usadas.
-    int symbols_per_column_count[MAX_KEY_LENGTH] = {0}; // Renomeado de symbols_per_column
+    if (argc > 1 && strcmp(argv[1], "--calibrate") == 0)
+    {
+        printf("Calibrando as implementacoes da cifra...\n");
+        adfgvx_calibrate(&profile, 1);
+        if (adfgvx_profile_save(&profile, DEFAULT_PROFILE_FILE) != 0)
+        {
+            fprintf(stderr, "Falha ao salvar o perfil de calibracao.\n");
+            return EXIT_FAILURE;
+        }
+        printf("Perfil salvo em '%s'.\n", DEFAULT_PROFILE_FILE);
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--search") == 0)
+    {
+        return run_key_search(argc > 2 ? atoi(argv[2]) : 0);
+    }
+
+    if (adfgvx_profile_load(&profile, DEFAULT_PROFILE_FILE) != 0)
+    {
+        // Sem calibracao: usa as escolhas padrao.
+        adfgvx_profile_set_default(&profile);
+    }
+
+    // Variaveis para armazenar a chave lida do arquivo.
+    char cipher_key_buffer[MAX_KEY_LENGTH]; // Renomeado de cipher_key
 
     int actual_key_length = 0; // Renomeado de KEY_LENGTH para clareza e evitar conflito com macros
     int file_read_status;      // Renomeado de is_file_read
@@ -47,19 +161,65 @@ int main()
     }
     printf("Chave lida: \"%s\" (Comprimento: %d)\n", cipher_key_buffer, actual_key_length);
 
+    if (argc > 1 && strcmp(argv[1], "--pipeline") == 0)
+    {
+        adfgvx_pipeline_stats stats;
+
+        printf("Cifrando '%s' em modo pipeline...\n", DEFAULT_MESSAGE_FILE);
+        // Mesmo formato da cifragem padrao: grupos de ADFGVX_GROUP_SIZE simbolos.
+        if (adfgvx_pipeline_encrypt_file(DEFAULT_MESSAGE_FILE, cipher_key_buffer, actual_key_length,
+                                         DEFAULT_ENCRYPTED_FILE, ADFGVX_GROUP_SIZE, ADFGVX_GROUPS_PER_LINE,
+                                         &stats) != 0)
+        {
+            fprintf(stderr, "Falha ao cifrar a mensagem em modo pipeline.\n");
+            return EXIT_FAILURE;
+        }
+        printf("Lidos %ld bytes, gravados %ld simbolos em '%s'.\n",
+               stats.bytes_read, stats.symbols_written, DEFAULT_ENCRYPTED_FILE);
+        printf("Tempos: contagem %.3fs, leitura %.3fs, calculo %.3fs, escrita %.3fs, total %.3fs\n",
+               stats.count_seconds, stats.read_seconds, stats.compute_seconds, stats.write_seconds,
+               stats.wall_seconds);
+        printf("Processo de cifragem concluido com sucesso!\n");
+        return EXIT_SUCCESS;
+    }
 
-    // Matriz para armazenar os simbolos ADFGVX organizados por coluna.
-    // Usa VLA (Variable Length Array), uma funcionalidade do C99.
-    // A primeira dimensao  o comprimento real da chave.
-    // A segunda dimensao  MAX_MESSAGE_LENGTH, conforme esperado pelas funcoes do modulo de cifra.
-    char intermediate_encoded_matrix[actual_key_length][MAX_MESSAGE_LENGTH]; // Renomeado de encoded_symbol_matrix
+
+    // Mensagem e texto cifrado ficam em uma area de trabalho dimensionada pelo arquivo da
+    // mensagem, e nao em buffers fixos na pilha.
+    long message_file_size = get_file_size(DEFAULT_MESSAGE_FILE);
+    if (message_file_size < 0)
+    {
+        fprintf(stderr, "Erro abrindo arquivo da mensagem '%s'.\n", DEFAULT_MESSAGE_FILE);
+        return EXIT_FAILURE;
+    }
+    // O texto cifrado (ate dois simbolos por caractere) precisa caber em um int.
+    if (message_file_size > (INT_MAX - 1) / 2)
+    {
+        fprintf(stderr, "Mensagem grande demais para a cifragem em memoria; use --pipeline.\n");
+        return EXIT_FAILURE;
+    }
+    int message_capacity = (int)message_file_size + 1;
+    // Texto cifrado linearizado (cada caractere gera no maximo dois simbolos).
+    int encrypted_capacity = 2 * (message_capacity - 1) + 1;
+
+    adfgvx_workspace workspace;
+    adfgvx_workspace_init(&workspace, NULL, 0);
+    if (adfgvx_workspace_reserve(&workspace, adfgvx_workspace_region_size(message_capacity) +
+                                                 adfgvx_workspace_region_size(encrypted_capacity)) != 0)
+    {
+        fprintf(stderr, "Memoria insuficiente para a mensagem.\n");
+        return EXIT_FAILURE;
+    }
+    char *message_buffer = adfgvx_workspace_alloc(&workspace, message_capacity); // Renomeado de message
+    char *encrypted_buffer = adfgvx_workspace_alloc(&workspace, encrypted_capacity);
 
     // Ler a mensagem do arquivo
     printf("Lendo mensagem de '%s'...\n", DEFAULT_MESSAGE_FILE);
-    file_read_status = read_file(DEFAULT_MESSAGE_FILE, message_buffer, MAX_MESSAGE_LENGTH);
+    file_read_status = read_file(DEFAULT_MESSAGE_FILE, message_buffer, message_capacity);
     if (file_read_status != 0)
     {
         fprintf(stderr, "Erro lendo arquivo da mensagem '%s'. Codigo: %d\n", DEFAULT_MESSAGE_FILE, file_read_status);
+        adfgvx_workspace_release(&workspace);
         return EXIT_FAILURE;
     }
     // Para mensagens longas, imprimir apenas uma parte pode ser util
@@ -68,18 +228,27 @@ int main()
 
 
     // Realizar a cifra ADFGVX
-    // symbols_per_column_count ja esta inicializado com zeros.
+    // O despachante escolhe a implementacao mais rapida para este tamanho de mensagem e chave.
     printf("Cifrando a mensagem...\n");
-    cipher_adfgvx(cipher_key_buffer, actual_key_length, message_buffer, intermediate_encoded_matrix, symbols_per_column_count);
+    if (cipher_adfgvx_auto(&profile, cipher_key_buffer, actual_key_length, message_buffer,
+                           encrypted_buffer, encrypted_capacity) != 0)
+    {
+        fprintf(stderr, "Falha ao cifrar a mensagem.\n");
+        adfgvx_workspace_release(&workspace);
+        return EXIT_FAILURE;
+    }
 
-    // Salvar a mensagem cifrada em 'encrypted.txt' usando a nova funcao dedicada
+    // Salvar a mensagem cifrada (ja linearizada) em 'encrypted.txt'
     printf("Salvando mensagem cifrada em '%s'...\n", DEFAULT_ENCRYPTED_FILE);
-    if (write_encrypted_data_to_file(DEFAULT_ENCRYPTED_FILE, actual_key_length, intermediate_encoded_matrix, symbols_per_column_count) != 0)
+    // Formato convencional: grupos de ADFGVX_GROUP_SIZE simbolos, ADFGVX_GROUPS_PER_LINE por linha.
+    if (write_ciphertext_to_file(DEFAULT_ENCRYPTED_FILE, encrypted_buffer, ADFGVX_GROUP_SIZE, ADFGVX_GROUPS_PER_LINE) != 0)
     {
-        // A funcao write_encrypted_data_to_file ja imprime um erro com perror.
+        // A funcao write_ciphertext_to_file ja imprime um erro com perror.
         fprintf(stderr, "Falha ao salvar a mensagem cifrada.\n");
+        adfgvx_workspace_release(&workspace);
         return EXIT_FAILURE;
     }
+    adfgvx_workspace_release(&workspace);
 
     printf("Processo de cifragem concluido com sucesso!\n");
     return EXIT_SUCCESS; // Ou return 0;
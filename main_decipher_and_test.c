@@ -2,11 +2,24 @@
 #include <string.h>
 #include <stdlib.h> // Para EXIT_SUCCESS, EXIT_FAILURE
 #include <time.h>   // Para test_execution_time
+#include <pthread.h> // Para o teste de leitores concorrentes do cache
 
 #include "cipher_config.h"
 #include "file_operations.h"
 #include "adfgvx_core.h"     // Para cipher_adfgvx (usado em testes)
 #include "adfgvx_decipher.h" // Para decipher_adfgvx
+#include "adfgvx_stream.h"    // Para a decifragem em fluxo
+#include "adfgvx_batch.h"     // Para a cifragem em lote
+#include "adfgvx_dispatch.h"  // Para o despachante calibrado
+#include "adfgvx_column_store.h" // Para o armazenamento por colunas
+#include "adfgvx_crib.h"      // Para a busca com trecho conhecido
+#include "adfgvx_pipeline.h"  // Para a cifragem de arquivos grandes em pipeline
+#include "fractionating_cipher.h" // Para as variantes ADFGX / ADFGVX / 8x8
+#include "adfgvx_cache.h"      // Para o cache de resultados
+#include "adfgvx_format.h"     // Para a leitura e escrita de texto cifrado agrupado
+#include "adfgvx_keylen.h"     // Para a estimativa do comprimento da chave
+#include "adfgvx_workspace.h"  // Para as areas de trabalho da decifragem
+#include "adfgvx_shard.h"      // Para a busca distribuida de chaves
 
 // --- Funes de Teste (Adaptadas do cdigo monoltico) ---
 
@@ -27,8 +40,22 @@ static void test_decipher(const char *test_name, char key[], char original_messa
     }
 
 
-    // VLA para a matriz de cifragem
-    char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+    // Matriz de cifragem e buffers de texto em uma area de trabalho dimensionada pela mensagem
+    // (a matriz de cipher_adfgvx() continua com colunas de MAX_MESSAGE_LENGTH posicoes).
+    int message_length = strlen(original_message);
+    long matrix_bytes = (long)key_length * MAX_MESSAGE_LENGTH;
+    adfgvx_workspace workspace;
+    adfgvx_workspace_init(&workspace, NULL, 0);
+    if (adfgvx_workspace_reserve(&workspace, adfgvx_workspace_region_size(matrix_bytes) +
+                                                 adfgvx_workspace_region_size(2 * message_length + 1) +
+                                                 adfgvx_workspace_region_size(message_length + 1)) != 0)
+    {
+        printf("\tERRO: Memoria insuficiente para o teste.\n");
+        return;
+    }
+    char (*encoded_symbol_matrix)[MAX_MESSAGE_LENGTH] = adfgvx_workspace_alloc(&workspace, matrix_bytes);
+    char *encrypted_linear = adfgvx_workspace_alloc(&workspace, 2 * message_length + 1);
+    char *decrypted_output = adfgvx_workspace_alloc(&workspace, message_length + 1);
     // Usar MAX_KEY_LENGTH para symbols_per_column  mais seguro se key_length for varivel
     // ou inicializar um VLA com key_length. Para consistncia com o main original:
     int symbols_per_column[MAX_KEY_LENGTH] = {0};
@@ -37,17 +64,16 @@ static void test_decipher(const char *test_name, char key[], char original_messa
     cipher_adfgvx(key, key_length, original_message, encoded_symbol_matrix, symbols_per_column);
 
     // Linearizar mensagem cifrada para alimentar a decifragem
-    char encrypted_linear[MAX_MESSAGE_LENGTH * 2 + 1];
     int pos = 0;
     for (int i = 0; i < key_length; i++)
     {
         for (int j = 0; j < symbols_per_column[i]; j++)
         {
-            if (pos < MAX_MESSAGE_LENGTH * 2) { // Protege o buffer
+            if (pos < 2 * message_length) { // Protege o buffer
                 encrypted_linear[pos++] = encoded_symbol_matrix[i][j];
             } else {
                 printf("\tERRO INTERNO DO TESTE: Buffer de encrypted_linear cheio durante a linearizao.\n");
-                encrypted_linear[pos] = '\0';
+                adfgvx_workspace_release(&workspace);
                 return; // No pode continuar o teste
             }
         }
@@ -55,7 +81,6 @@ static void test_decipher(const char *test_name, char key[], char original_messa
     encrypted_linear[pos] = '\0';
 
     // Decifrar usando o mdulo adfgvx_decipher
-    char decrypted_output[MAX_MESSAGE_LENGTH];
     decipher_adfgvx(encrypted_linear, key, key_length, decrypted_output);
 
     printf("\t\tMensagem Original:  \"%.50s%s\"\n", original_message, strlen(original_message) > 50 ? "..." : "");
@@ -71,6 +96,7 @@ static void test_decipher(const char *test_name, char key[], char original_messa
     {
         printf("\tERRO: A decifragem falhou. Mensagens no correspondem.\n");
     }
+    adfgvx_workspace_release(&workspace);
 }
 
 /**
@@ -169,15 +195,1210 @@ static void test_invalid_character() // Nome original do monol
 }
 
 
+/**
+ * @brief Verifica se a decifragem em fluxo produz o mesmo resultado que decipher_adfgvx().
+ * Usa uma janela de saida pequena para exercitar a retomada entre chamadas.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_stream_decipher(void)
+{
+    printf("\n-> Teste: Decifragem em Fluxo\n");
+    char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    char message[] = "DECIFRAGEM EM FLUXO, COM TRECHOS PEQUENOS E UMA CHAVE DE OITO CARACTERES.";
+
+    char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+    int symbols_per_column[MAX_KEY_LENGTH] = {0};
+    cipher_adfgvx(key, key_length, message, encoded_symbol_matrix, symbols_per_column);
+
+    char encrypted_linear[MAX_MESSAGE_LENGTH * 2 + 1];
+    int pos = 0;
+    for (int i = 0; i < key_length; i++)
+    {
+        for (int j = 0; j < symbols_per_column[i]; j++)
+        {
+            encrypted_linear[pos++] = encoded_symbol_matrix[i][j];
+        }
+    }
+    encrypted_linear[pos] = '\0';
+
+    static adfgvx_decipher_stream stream; // Estado grande: evita a pilha
+    char streamed[MAX_MESSAGE_LENGTH];
+    char chunk[7];
+    int total = 0, n;
+
+    if (adfgvx_stream_open_memory(&stream, encrypted_linear, pos, key, key_length) != 0)
+    {
+        printf("\tERRO: Nao foi possivel abrir o fluxo de decifragem.\n");
+        return;
+    }
+    // Uma janela vazia e erro do chamador, e nao pode ser confundida com o fim da mensagem.
+    int empty_window_rejected = adfgvx_stream_read(&stream, chunk, 0) == -1;
+    while ((n = adfgvx_stream_read(&stream, chunk, (int)sizeof(chunk))) > 0)
+    {
+        memcpy(streamed + total, chunk, n);
+        total += n;
+    }
+    adfgvx_stream_close(&stream);
+    streamed[total] = '\0';
+
+    printf("\t\tMensagem Original:  \"%.50s%s\"\n", message, strlen(message) > 50 ? "..." : "");
+    printf("\t\tMensagem em Fluxo:  \"%.50s%s\"\n", streamed, strlen(streamed) > 50 ? "..." : "");
+
+    // Fluxo sobre arquivos gravados por write_ciphertext_to_file(), em grupos (o formato do
+    // encrypted.txt) e linear. Com a chave de um caractere, a coluna ocupa varias janelas.
+    static char long_message[MAX_MESSAGE_LENGTH];
+    static char long_matrix[MAX_KEY_LENGTH][MAX_MESSAGE_LENGTH];
+    static char long_encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    static char long_streamed[MAX_MESSAGE_LENGTH];
+    int long_length = MAX_MESSAGE_LENGTH - 1;
+    for (int i = 0; i < long_length; i++)
+        long_message[i] = message[i % (int)strlen(message)];
+    long_message[long_length] = '\0';
+
+    char *file_keys[] = {key, "K"};
+    const int group_sizes[] = {ADFGVX_GROUP_SIZE, 0};
+    int file_failures = 0;
+    for (int k = 0; k < 2; k++)
+    {
+        int file_key_length = strlen(file_keys[k]);
+        int long_symbols_per_column[MAX_KEY_LENGTH] = {0};
+        cipher_adfgvx(file_keys[k], file_key_length, long_message, long_matrix, long_symbols_per_column);
+        int long_pos = 0;
+        for (int i = 0; i < file_key_length; i++)
+        {
+            memcpy(long_encrypted + long_pos, long_matrix[i], long_symbols_per_column[i]);
+            long_pos += long_symbols_per_column[i];
+        }
+        long_encrypted[long_pos] = '\0';
+
+        for (int g = 0; g < 2; g++)
+        {
+            int long_total = 0;
+            if (write_ciphertext_to_file(DEFAULT_GROUPED_FILE_FOR_TEST, long_encrypted, group_sizes[g],
+                                         ADFGVX_GROUPS_PER_LINE) != 0 ||
+                adfgvx_stream_open_file(&stream, DEFAULT_GROUPED_FILE_FOR_TEST, file_keys[k], file_key_length) != 0)
+            {
+                file_failures++;
+                continue;
+            }
+            while ((n = adfgvx_stream_read(&stream, long_streamed + long_total, 100)) > 0)
+                long_total += n;
+            adfgvx_stream_close(&stream);
+            if (n != 0 || long_total != long_length || memcmp(long_streamed, long_message, long_length) != 0)
+            {
+                printf("\t\tArquivo com chave \"%s\" e grupos de %d: decifragem em fluxo difere.\n",
+                       file_keys[k], group_sizes[g]);
+                file_failures++;
+            }
+        }
+    }
+
+    if (empty_window_rejected && n == 0 && strcmp(message, streamed) == 0 && file_failures == 0)
+    {
+        printf("\tSUCESSO: Decifragem em fluxo corresponde a original!\n");
+    }
+    else
+    {
+        printf("\tERRO: A decifragem em fluxo falhou.\n");
+    }
+}
+
+
+/**
+ * @brief Verifica se a cifragem em lote produz, para cada mensagem, o mesmo texto cifrado
+ * que cipher_adfgvx(). Usa mais mensagens que ADFGVX_BATCH_LANES e comprimentos variados.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_batch_cipher(void)
+{
+    printf("\n-> Teste: Cifragem em Lote\n");
+    char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    const char *messages[] = {
+        "LUCAS", "", "OI", "L#UC%AS@!d", "ATAQUE AO AMANHECER.",
+        "STATUS OK", "STATUS OK, NENHUM ALERTA.", "A", "1234567", "NODE 7 ONLINE",
+        "TESTANDO A CIFRA ADFGVX COM UMA MENSAGEM UM POUCO MAIOR PARA PASSAR DE UM BLOCO DE SESSENTA E QUATRO CARACTERES.",
+        "X", "ZZ", "MENSAGEM DEZESSEIS", "DEZESSETE", "DEZOITO", "DEZENOVE", "VINTE"};
+    int message_count = (int)(sizeof(messages) / sizeof(messages[0]));
+
+    char arena[MAX_MESSAGE_LENGTH];
+    long offsets[sizeof(messages) / sizeof(messages[0]) + 1];
+
+    if (cipher_adfgvx_batch(key, key_length, messages, message_count, arena, sizeof(arena), offsets) != 0)
+    {
+        printf("\tERRO: cipher_adfgvx_batch falhou.\n");
+        return;
+    }
+
+    int mismatches = 0;
+    for (int m = 0; m < message_count; m++)
+    {
+        char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+        int symbols_per_column[MAX_KEY_LENGTH] = {0};
+        char message[MAX_MESSAGE_LENGTH];
+        char expected[MAX_MESSAGE_LENGTH * 2 + 1];
+        int pos = 0;
+
+        strcpy(message, messages[m]);
+        cipher_adfgvx(key, key_length, message, encoded_symbol_matrix, symbols_per_column);
+        for (int i = 0; i < key_length; i++)
+        {
+            for (int j = 0; j < symbols_per_column[i]; j++)
+            {
+                expected[pos++] = encoded_symbol_matrix[i][j];
+            }
+        }
+
+        if (offsets[m + 1] - offsets[m] != pos || memcmp(arena + offsets[m], expected, pos) != 0)
+        {
+            printf("\t\tDivergencia na mensagem %d: \"%s\"\n", m, messages[m]);
+            mismatches++;
+        }
+    }
+
+    printf("\t\tMensagens no lote: %d (lanes: %d)\n", message_count, ADFGVX_BATCH_LANES);
+    if (mismatches == 0)
+    {
+        printf("\tSUCESSO: Cifragem em lote corresponde a cipher_adfgvx!\n");
+    }
+    else
+    {
+        printf("\tERRO: %d mensagens do lote divergem de cipher_adfgvx.\n", mismatches);
+    }
+}
+
+
+/**
+ * @brief Calibra as implementacoes, salva e rele o perfil, e verifica se o despachante
+ * produz os mesmos resultados que cada implementacao para todos os comprimentos de chave.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_dispatch(void)
+{
+    printf("\n-> Teste: Despachante Calibrado\n");
+    const char key[] = "SEMB2025";
+    const char message[] = "ATAQUE AO AMANHECER, 1234567 UNIDADES NO SETOR NORTE.";
+    adfgvx_profile calibrated, loaded;
+    char expected[MAX_MESSAGE_LENGTH * 2 + 1];
+    char actual[MAX_MESSAGE_LENGTH * 2 + 1];
+    char decrypted[MAX_MESSAGE_LENGTH];
+    int failures = 0;
+
+    clock_t start_time = clock();
+    adfgvx_calibrate(&calibrated, 0);
+    double elapsed_seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+    printf("\t\tTempo de calibracao: %.3f segundos\n", elapsed_seconds);
+
+    if (adfgvx_profile_save(&calibrated, DEFAULT_PROFILE_FILE_FOR_TEST) != 0 ||
+        adfgvx_profile_load(&loaded, DEFAULT_PROFILE_FILE_FOR_TEST) != 0 ||
+        memcmp(&calibrated, &loaded, sizeof(calibrated)) != 0)
+    {
+        printf("\t\tPerfil relido de '%s' difere do calibrado.\n", DEFAULT_PROFILE_FILE_FOR_TEST);
+        failures++;
+    }
+
+    for (int k = 1; k < MAX_KEY_LENGTH; k++)
+    {
+        cipher_adfgvx_with_path(ADFGVX_CIPHER_PATH_MATRIX, key, k, message, expected, sizeof(expected));
+        for (int p = 0; p < ADFGVX_CIPHER_PATH_COUNT; p++)
+        {
+            cipher_adfgvx_with_path((adfgvx_cipher_path)p, key, k, message, actual, sizeof(actual));
+            failures += strcmp(expected, actual) != 0;
+        }
+        cipher_adfgvx_auto(&loaded, key, k, message, actual, sizeof(actual));
+        failures += strcmp(expected, actual) != 0;
+
+        for (int p = 0; p < ADFGVX_DECIPHER_PATH_COUNT; p++)
+        {
+            decipher_adfgvx_with_path((adfgvx_decipher_path)p, expected, key, k, decrypted);
+            failures += strcmp(message, decrypted) != 0;
+        }
+        decipher_adfgvx_auto(&loaded, expected, key, k, decrypted);
+        failures += strcmp(message, decrypted) != 0;
+    }
+
+    // A matriz e dimensionada pela mensagem, e nao por MAX_MESSAGE_LENGTH: uma mensagem tres
+    // vezes maior que o limite antigo cifra igual pelos dois caminhos, com chaves curta e longa.
+    static char long_message[MAX_MESSAGE_LENGTH * 3 + 1];
+    static char long_expected[MAX_MESSAGE_LENGTH * 6 + 1];
+    static char long_actual[MAX_MESSAGE_LENGTH * 6 + 1];
+    long long_length = MAX_MESSAGE_LENGTH * 3;
+    for (long i = 0; i < long_length; i++)
+        long_message[i] = message[i % (long)strlen(message)];
+    long_message[long_length] = '\0';
+    const int long_keys[] = {1, MAX_KEY_LENGTH - 1};
+    for (int t = 0; t < 2; t++)
+    {
+        int status = cipher_adfgvx_with_path(ADFGVX_CIPHER_PATH_CLOSED_FORM, key, long_keys[t], long_message,
+                                             long_expected, sizeof(long_expected));
+        status |= cipher_adfgvx_with_path(ADFGVX_CIPHER_PATH_MATRIX, key, long_keys[t], long_message,
+                                          long_actual, sizeof(long_actual));
+        failures += status != 0 || strcmp(long_expected, long_actual) != 0;
+    }
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: Todas as implementacoes e o despachante concordam.\n");
+    }
+    else
+    {
+        printf("\tERRO: %d divergencias entre implementacoes ou no perfil.\n", failures);
+    }
+}
+
+
+/**
+ * @brief Acrescenta linhas a um armazenamento por colunas (fechando e reabrindo no meio)
+ * e verifica se o texto cifrado linearizado e a decifragem direta correspondem a cifrar
+ * todo o texto de uma vez.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_column_store(void)
+{
+    printf("\n-> Teste: Armazenamento por Colunas com Acrescimos\n");
+    char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    const char *lines[] = {"EVENTO 1, LOGIN OK. ", "EVENTO 2, ARQUIVO ABERTO. ", "E", "VENTO 3, ",
+                           "LOGOUT.", "", " EVENTO 4, REINICIO AGENDADO PARA 23 HORAS."};
+    int line_count = (int)(sizeof(lines) / sizeof(lines[0]));
+    char full_message[MAX_MESSAGE_LENGTH] = "";
+    adfgvx_column_store store;
+    int status;
+
+    status = adfgvx_store_create(&store, DEFAULT_STORE_PREFIX_FOR_TEST, key_length);
+    for (int i = 0; i < line_count && status == 0; i++)
+    {
+        if (i == line_count / 2)
+        {
+            // Simula uma queda no meio de um acrescimo: simbolos a mais no fim de um segmento e
+            // um manifesto temporario pela metade. O estado vem apenas do manifesto confirmado.
+            adfgvx_store_close(&store);
+            char crash_path[ADFGVX_STORE_PATH_MAX + 16];
+            FILE *crash_file;
+            snprintf(crash_path, sizeof(crash_path), "%s.col0", DEFAULT_STORE_PREFIX_FOR_TEST);
+            if ((crash_file = fopen(crash_path, "ab")) != NULL)
+            {
+                fputs("XXXX", crash_file);
+                fclose(crash_file);
+            }
+            snprintf(crash_path, sizeof(crash_path), "%s.manifest.tmp", DEFAULT_STORE_PREFIX_FOR_TEST);
+            if ((crash_file = fopen(crash_path, "w")) != NULL)
+            {
+                fputs("ADFGVX-COLUMN-ST", crash_file);
+                fclose(crash_file);
+            }
+            status = adfgvx_store_open(&store, DEFAULT_STORE_PREFIX_FOR_TEST);
+            if (status != 0)
+                break;
+        }
+        if (i == line_count - 1)
+        {
+            // Ultimo trecho pelas etapas separadas: gravado sem manifesto e confirmado uma vez.
+            char grouped[2 * 64];
+            long column_fill[MAX_KEY_LENGTH];
+            long symbol_count = adfgvx_store_encode_chunk(key_length, store.symbol_count, lines[i],
+                                                          (long)strlen(lines[i]), grouped, column_fill);
+            status = adfgvx_store_append_encoded(&store, grouped, column_fill, symbol_count);
+            if (status == 0)
+                status = adfgvx_store_commit(&store);
+        }
+        else
+        {
+            status = adfgvx_store_append(&store, lines[i], (long)strlen(lines[i]));
+        }
+        strcat(full_message, lines[i]);
+    }
+    if (status != 0)
+    {
+        printf("\tERRO: Falha ao montar o armazenamento (codigo %d).\n", status);
+        adfgvx_store_close(&store);
+        return;
+    }
+
+    // Referencia: cifrar o texto completo de uma vez.
+    char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+    int symbols_per_column[MAX_KEY_LENGTH] = {0};
+    char expected[MAX_MESSAGE_LENGTH * 2 + 1];
+    int pos = 0;
+    cipher_adfgvx(key, key_length, full_message, encoded_symbol_matrix, symbols_per_column);
+    for (int i = 0; i < key_length; i++)
+    {
+        for (int j = 0; j < symbols_per_column[i]; j++)
+        {
+            expected[pos++] = encoded_symbol_matrix[i][j];
+        }
+    }
+    expected[pos] = '\0';
+
+    char materialized[MAX_MESSAGE_LENGTH * 2 + 1] = "";
+    char materialized_file[ADFGVX_STORE_PATH_MAX + 16];
+    snprintf(materialized_file, sizeof(materialized_file), "%s.txt", DEFAULT_STORE_PREFIX_FOR_TEST);
+    int materialized_ok = adfgvx_store_write_ciphertext(&store, key, materialized_file) == 0 &&
+                          read_file(materialized_file, materialized, sizeof(materialized)) == 0 &&
+                          strcmp(expected, materialized) == 0;
+
+    static adfgvx_decipher_stream stream;
+    char streamed[MAX_MESSAGE_LENGTH];
+    int total = 0, n = -1;
+    if (adfgvx_store_open_stream(&store, key, &stream) == 0)
+    {
+        while ((n = adfgvx_stream_read(&stream, streamed + total, 5)) > 0)
+            total += n;
+        adfgvx_stream_close(&stream);
+    }
+    streamed[total] = '\0';
+    adfgvx_store_close(&store);
+
+    // Um total acima de 2^32 simbolos volta do manifesto sem truncar (long tem 32 bits no MinGW).
+    char manifest_path[ADFGVX_STORE_PATH_MAX + 16];
+    snprintf(manifest_path, sizeof(manifest_path), "%s.manifest", DEFAULT_STORE_PREFIX_FOR_TEST);
+    FILE *manifest = fopen(manifest_path, "w");
+    int large_ok = 0;
+    if (manifest != NULL)
+    {
+        fprintf(manifest, "ADFGVX-COLUMN-STORE 1\nkey_length %d\nsymbols 4294967298\n", key_length);
+        fclose(manifest);
+        large_ok = adfgvx_store_open(&store, DEFAULT_STORE_PREFIX_FOR_TEST) == 0 &&
+                   store.symbol_count == INT64_C(4294967298);
+        adfgvx_store_close(&store);
+    }
+
+    printf("\t\tSimbolos armazenados: %d\n", pos);
+    printf("\t\tDecifrado dos segmentos: \"%.50s%s\"\n", streamed, strlen(streamed) > 50 ? "..." : "");
+
+    if (materialized_ok && large_ok && n == 0 && strcmp(full_message, streamed) == 0)
+    {
+        printf("\tSUCESSO: Armazenamento por colunas corresponde a cifragem completa!\n");
+    }
+    else
+    {
+        printf("\tERRO: Armazenamento por colunas divergente (linearizado: %s, decifrado: %s).\n",
+               materialized_ok ? "ok" : "falhou", strcmp(full_message, streamed) == 0 ? "ok" : "falhou");
+    }
+}
+
+
+/**
+ * @brief Cifra uma mensagem, procura as ordenacoes compativeis com um trecho conhecido e
+ * verifica se a chave canonica de alguma sobrevivente decifra a mensagem original.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_crib_search(void)
+{
+    printf("\n-> Teste: Busca de Chave com Trecho Conhecido\n");
+    char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    char message[] = "RELATORIO DIARIO. TODAS AS UNIDADES EM POSICAO, AGUARDANDO ORDENS DO COMANDO CENTRAL.";
+    const char crib[] = "TODAS AS UNIDADES";
+
+    char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+    int symbols_per_column[MAX_KEY_LENGTH] = {0};
+    char encrypted_linear[MAX_MESSAGE_LENGTH * 2 + 1];
+    int pos = 0;
+    cipher_adfgvx(key, key_length, message, encoded_symbol_matrix, symbols_per_column);
+    for (int i = 0; i < key_length; i++)
+    {
+        for (int j = 0; j < symbols_per_column[i]; j++)
+        {
+            encrypted_linear[pos++] = encoded_symbol_matrix[i][j];
+        }
+    }
+    encrypted_linear[pos] = '\0';
+
+    static adfgvx_crib_report report;
+    if (adfgvx_crib_search(encrypted_linear, key_length, crib, ADFGVX_CRIB_THREADS, &report) != 0)
+    {
+        printf("\tERRO: adfgvx_crib_search falhou.\n");
+        return;
+    }
+
+    int recovered = -1;
+    char decrypted[MAX_MESSAGE_LENGTH];
+    for (int m = 0; m < report.match_count && recovered < 0; m++)
+    {
+        decipher_adfgvx(encrypted_linear, report.matches[m].key, key_length, decrypted);
+        if (strcmp(decrypted, message) == 0)
+            recovered = m;
+    }
+
+    printf("\t\tTrecho conhecido: \"%s\"\n", crib);
+    printf("\t\tOrdenacoes sobreviventes: %ld (espaco coberto: %.0f pares posicao/ordenacao)\n",
+           report.total_matches, report.space_covered);
+    printf("\t\tTempo: %.6f segundos (%ld nos visitados, %.0f nos/segundo)\n",
+           report.elapsed_seconds, report.nodes_visited, report.nodes_per_second);
+
+    if (recovered >= 0)
+    {
+        printf("\tSUCESSO: Chave equivalente \"%s\" recuperada (posicao %ld do trecho).\n",
+               report.matches[recovered].key, report.matches[recovered].offset);
+    }
+    else
+    {
+        printf("\tERRO: Nenhuma ordenacao sobrevivente decifra a mensagem original.\n");
+    }
+}
+
+
+/**
+ * @brief Le um arquivo inteiro, sem nenhuma conversao, para comparacoes byte a byte.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ *
+ * @return long Numero de bytes lidos, ou -1 se o arquivo nao abrir ou nao couber em buffer.
+ */
+static long read_whole_file(const char *filename, char *buffer, long capacity)
+{
+    FILE *file_ptr = fopen(filename, "rb");
+    if (file_ptr == NULL)
+        return -1;
+    long length = (long)fread(buffer, 1, (size_t)capacity, file_ptr);
+    int too_large = fgetc(file_ptr) != EOF;
+    fclose(file_ptr);
+    return too_large ? -1 : length;
+}
+
+/**
+ * @brief Cifra um arquivo de varios trechos em modo pipeline e compara o arquivo gerado, byte a
+ * byte, com o de write_ciphertext_to_file() para a cifragem da mensagem inteira.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_pipeline(void)
+{
+    printf("\n-> Teste: Cifragem em Pipeline\n");
+    const char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    const char line[] = "LINHA DE REGISTRO 1234567, TUDO NORMAL.\n";
+    long line_length = (long)strlen(line);
+    long message_length = 3 * ADFGVX_PIPELINE_CHUNK + 123;
+    long formatted_capacity = adfgvx_format_size(2 * message_length, ADFGVX_GROUP_SIZE) + 2;
+    char message_file[64], encrypted_file[64], reference_file[64];
+    adfgvx_pipeline_stats stats;
+
+    snprintf(message_file, sizeof(message_file), "%s_message.txt", DEFAULT_PIPELINE_PREFIX_FOR_TEST);
+    snprintf(encrypted_file, sizeof(encrypted_file), "%s_encrypted.txt", DEFAULT_PIPELINE_PREFIX_FOR_TEST);
+    snprintf(reference_file, sizeof(reference_file), "%s_reference.txt", DEFAULT_PIPELINE_PREFIX_FOR_TEST);
+
+    char *message = malloc(message_length + 1);
+    char *expected = malloc(2 * message_length + 1);
+    char *expected_file_data = malloc(formatted_capacity);
+    char *actual_file_data = malloc(formatted_capacity);
+    if (message == NULL || expected == NULL || expected_file_data == NULL || actual_file_data == NULL)
+    {
+        printf("\tERRO: Memoria insuficiente para o teste.\n");
+        free(message);
+        free(expected);
+        free(expected_file_data);
+        free(actual_file_data);
+        return;
+    }
+
+    for (long i = 0; i < message_length; i++)
+        message[i] = line[i % line_length];
+    message[message_length] = '\0';
+
+    const char *messages[1] = {message};
+    long offsets[2];
+    cipher_adfgvx_batch(key, key_length, messages, 1, expected, 2 * message_length, offsets);
+    expected[offsets[1]] = '\0';
+
+    // Referencia: o caminho padrao de main.c (cifragem inteira + write_ciphertext_to_file()).
+    int status = write_plaintext_to_file(message_file, message);
+    if (status == 0)
+        status = write_ciphertext_to_file(reference_file, expected, ADFGVX_GROUP_SIZE, ADFGVX_GROUPS_PER_LINE);
+    if (status == 0)
+        status = adfgvx_pipeline_encrypt_file(message_file, key, key_length, encrypted_file,
+                                              ADFGVX_GROUP_SIZE, ADFGVX_GROUPS_PER_LINE, &stats);
+
+    long expected_length = status == 0 ? read_whole_file(reference_file, expected_file_data, formatted_capacity) : -1;
+    long actual_length = status == 0 ? read_whole_file(encrypted_file, actual_file_data, formatted_capacity) : -1;
+
+    if (status == 0)
+    {
+        printf("\t\tLidos %ld bytes em trechos de %d, %ld simbolos gravados em grupos de %d\n",
+               stats.bytes_read, ADFGVX_PIPELINE_CHUNK, stats.symbols_written, ADFGVX_GROUP_SIZE);
+        printf("\t\tContagem %.4fs, leitura %.4fs, calculo %.4fs, escrita %.4fs, total %.4fs\n",
+               stats.count_seconds, stats.read_seconds, stats.compute_seconds, stats.write_seconds,
+               stats.wall_seconds);
+    }
+
+    if (status == 0 && expected_length > 0 && actual_length == expected_length &&
+        memcmp(expected_file_data, actual_file_data, (size_t)expected_length) == 0)
+    {
+        printf("\tSUCESSO: Cifragem em pipeline corresponde a cifragem da mensagem inteira!\n");
+    }
+    else
+    {
+        printf("\tERRO: A cifragem em pipeline falhou (codigo %d) ou diverge (%ld de %ld bytes).\n",
+               status, actual_length, expected_length);
+    }
+
+    free(message);
+    free(expected);
+    free(expected_file_data);
+    free(actual_file_data);
+}
+
+
+/**
+ * @brief Verifica as variantes da familia fracionada: ida e volta em cada matriz, a fusao
+ * I/J do ADFGX, as minusculas do 8x8 e a equivalencia da variante 6x6 com cipher_adfgvx().
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_fractionating_variants(void)
+{
+    printf("\n-> Teste: Variantes da Cifra Fracionada\n");
+    char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    const struct
+    {
+        const fractionating_variant *variant;
+        const char *message;
+        const char *expected;
+    } cases[] = {
+        {&FRACTIONATING_ADFGX, "JUJUBA NO QUINTAL", "IUIUBANOQUINTAL"},
+        {&FRACTIONATING_ADFGVX, "ATAQUE AS 1745 NA PONTE 7", "ATAQUE AS 1745 NA PONTE 7"},
+        {&FRACTIONATING_ADFGVX8, "Ola, Mundo! (x=42; y<7?) [ok]", "OLA, MUNDO! (X=42; Y<7?) [OK]"},
+    };
+    char encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    char decrypted[MAX_MESSAGE_LENGTH];
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        int status = fractionating_encrypt(cases[i].variant, key, key_length, cases[i].message,
+                                           encrypted, sizeof(encrypted));
+        if (status == 0)
+            status = fractionating_decrypt(cases[i].variant, encrypted, key, key_length,
+                                           decrypted, sizeof(decrypted));
+
+        printf("\t\t%-7s (%dx%d): \"%s\" -> \"%.30s%s\"\n", cases[i].variant->name,
+               cases[i].variant->grid_size, cases[i].variant->grid_size, cases[i].message,
+               encrypted, strlen(encrypted) > 30 ? "..." : "");
+        if (status != 0 || strcmp(decrypted, cases[i].expected) != 0)
+        {
+            printf("\tERRO: %s decifrou \"%s\" (codigo %d), esperado \"%s\".\n",
+                   cases[i].variant->name, decrypted, status, cases[i].expected);
+            failures++;
+        }
+    }
+
+    // A variante 6x6 deve produzir exatamente o texto de cipher_adfgvx().
+    char message[] = "TESTANDO A CIFRA ADFGVX COM A MATRIZ 6X6 PADRAO, 2025.";
+    char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+    int symbols_per_column[MAX_KEY_LENGTH] = {0};
+    char expected[MAX_MESSAGE_LENGTH * 2 + 1];
+    int pos = 0;
+    cipher_adfgvx(key, key_length, message, encoded_symbol_matrix, symbols_per_column);
+    for (int i = 0; i < key_length; i++)
+    {
+        for (int j = 0; j < symbols_per_column[i]; j++)
+        {
+            expected[pos++] = encoded_symbol_matrix[i][j];
+        }
+    }
+    expected[pos] = '\0';
+
+    if (fractionating_encrypt(&FRACTIONATING_ADFGVX, key, key_length, message, encrypted, sizeof(encrypted)) != 0 ||
+        strcmp(encrypted, expected) != 0)
+    {
+        printf("\tERRO: A variante ADFGVX diverge de cipher_adfgvx().\n");
+        failures++;
+    }
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: Todas as variantes decifram corretamente e a 6x6 corresponde a cipher_adfgvx()!\n");
+    }
+}
+
+/**
+ * @brief Argumentos de uma thread do teste do cache.
+ */
+typedef struct cache_test_worker
+{
+    adfgvx_cache *cache;
+    const char *key;
+    const char *const *messages;
+    const char (*expected)[MAX_MESSAGE_LENGTH * 2 + 1];
+    int message_count;
+    int failures;
+} cache_test_worker;
+
+/**
+ * @brief Thread do teste do cache: cifra e decifra repetidamente as mesmas mensagens.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void *cache_test_thread(void *arg)
+{
+    cache_test_worker *worker = arg;
+    int key_length = strlen(worker->key);
+    char encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    char decrypted[MAX_MESSAGE_LENGTH];
+
+    for (int round = 0; round < 200; round++)
+    {
+        int m = round % worker->message_count;
+        cipher_adfgvx_cached(worker->cache, NULL, worker->key, key_length, worker->messages[m],
+                             encrypted, sizeof(encrypted));
+        decipher_adfgvx_cached(worker->cache, NULL, encrypted, worker->key, key_length, decrypted);
+        worker->failures += strcmp(encrypted, worker->expected[m]) != 0;
+        worker->failures += strcmp(decrypted, worker->messages[m]) != 0;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Verifica o cache de resultados: acertos e faltas, resultados iguais aos sem cache,
+ * descarte LRU com limite de memoria pequeno e consultas simultaneas de varias threads.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_result_cache(void)
+{
+    printf("\n-> Teste: Cache de Resultados\n");
+    const char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    const char *const messages[] = {
+        "STATUS, SISTEMA OPERANDO NORMALMENTE.",
+        "STATUS, BATERIA EM 75 POR CENTO.",
+        "STATUS, SINCRONIZACAO CONCLUIDA.",
+        "ALERTA, TEMPERATURA ACIMA DO LIMITE.",
+    };
+    int message_count = sizeof(messages) / sizeof(messages[0]);
+    char expected[sizeof(messages) / sizeof(messages[0])][MAX_MESSAGE_LENGTH * 2 + 1];
+    char encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    adfgvx_cache_stats stats;
+    int failures = 0;
+
+    for (int m = 0; m < message_count; m++)
+        cipher_adfgvx_auto(NULL, key, key_length, messages[m], expected[m], sizeof(expected[m]));
+
+    // 1) Cache amplo: so a primeira cifragem de cada mensagem e calculada.
+    adfgvx_cache *cache = adfgvx_cache_create(1L << 20);
+    if (cache == NULL)
+    {
+        printf("\tERRO: adfgvx_cache_create falhou.\n");
+        return;
+    }
+    for (int round = 0; round < 10; round++)
+    {
+        for (int m = 0; m < message_count; m++)
+        {
+            cipher_adfgvx_cached(cache, NULL, key, key_length, messages[m], encrypted, sizeof(encrypted));
+            failures += strcmp(encrypted, expected[m]) != 0;
+        }
+    }
+    adfgvx_cache_get_stats(cache, &stats);
+    printf("\t\tCache amplo: %ld acertos, %ld faltas, %ld descartes, %ld entradas, %ld bytes\n",
+           stats.hits, stats.misses, stats.evictions, stats.entries, stats.bytes);
+    failures += stats.misses != message_count || stats.hits != 9L * message_count || stats.evictions != 0;
+    adfgvx_cache_destroy(cache);
+
+    // 2) Cache com espaco para duas entradas: acessos ciclicos sempre descartam a mais antiga.
+    cache = adfgvx_cache_create(1L << 20);
+    cipher_adfgvx_cached(cache, NULL, key, key_length, messages[0], encrypted, sizeof(encrypted));
+    adfgvx_cache_get_stats(cache, &stats);
+    adfgvx_cache_destroy(cache);
+
+    cache = adfgvx_cache_create(2 * stats.bytes + stats.bytes / 2);
+    for (int round = 0; round < 3; round++)
+    {
+        for (int m = 0; m < 3; m++)
+        {
+            cipher_adfgvx_cached(cache, NULL, key, key_length, messages[m], encrypted, sizeof(encrypted));
+            failures += strcmp(encrypted, expected[m]) != 0;
+        }
+    }
+    // A mensagem 2 e a mais recente e deve continuar no cache.
+    cipher_adfgvx_cached(cache, NULL, key, key_length, messages[2], encrypted, sizeof(encrypted));
+    adfgvx_cache_get_stats(cache, &stats);
+    printf("\t\tCache pequeno: %ld acertos, %ld faltas, %ld descartes, %ld/%ld bytes\n",
+           stats.hits, stats.misses, stats.evictions, stats.bytes, stats.max_bytes);
+    failures += stats.hits != 1 || stats.misses != 9 || stats.evictions != 7 || stats.bytes > stats.max_bytes;
+    adfgvx_cache_destroy(cache);
+
+    // 3) Varias threads cifrando e decifrando as mesmas mensagens com um unico cache.
+    cache = adfgvx_cache_create(1L << 20);
+    pthread_t threads[4];
+    cache_test_worker workers[4];
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t] = (cache_test_worker){cache, key, messages, (const char (*)[MAX_MESSAGE_LENGTH * 2 + 1])expected,
+                                         message_count, 0};
+        pthread_create(&threads[t], NULL, cache_test_thread, &workers[t]);
+    }
+    for (int t = 0; t < 4; t++)
+    {
+        pthread_join(threads[t], NULL);
+        failures += workers[t].failures;
+    }
+    adfgvx_cache_get_stats(cache, &stats);
+    printf("\t\tConcorrente: %ld acertos, %ld faltas\n", stats.hits, stats.misses);
+    failures += stats.hits + stats.misses != 4L * 200 * 2;
+    adfgvx_cache_destroy(cache);
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: Resultados do cache correspondem a cifragem sem cache e os contadores conferem!\n");
+    }
+    else
+    {
+        printf("\tERRO: %d divergencias nos resultados ou contadores do cache.\n", failures);
+    }
+}
+
+/**
+ * @brief Verifica a leitura e a escrita de texto cifrado agrupado: formatacao em grupos e linhas,
+ * formatacao em partes, normalizacao de textos longos, posicao do primeiro caractere invalido e
+ * ida e volta por arquivo com write_encrypted_data_to_file() e read_ciphertext_file().
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_grouped_ciphertext(void)
+{
+    printf("\n-> Teste: Texto Cifrado Agrupado\n");
+    int failures = 0;
+
+    // 1) Formatacao direta e em partes.
+    const char symbols[] = "ADFGVXADFGVXADFGVXADFGV";
+    long count = (long)strlen(symbols);
+    char whole[64], parts[64];
+    long whole_length = adfgvx_format_ciphertext(symbols, count, 0, 5, 2, whole);
+    whole[whole_length] = '\0';
+    failures += strcmp(whole, "ADFGV XADFG\nVXADF GVXAD\nFGV") != 0;
+
+    long parts_length = 0;
+    for (long first = 0; first < count; first += 3)
+    {
+        long n = count - first < 3 ? count - first : 3;
+        parts_length += adfgvx_format_ciphertext(symbols + first, n, first, 5, 2, parts + parts_length);
+    }
+    parts[parts_length] = '\0';
+    failures += strcmp(whole, parts) != 0;
+
+    // Partes alem de 2^32 simbolos: os separadores dependem da posicao completa, de 64 bits.
+    parts_length = adfgvx_format_ciphertext(symbols, 5, INT64_C(42949672960), 5, 2, parts);
+    parts_length += adfgvx_format_ciphertext(symbols, 5, INT64_C(42949672965), 5, 2, parts + parts_length);
+    parts[parts_length] = '\0';
+    failures += strcmp(parts, "\nADFGV ADFGV") != 0;
+
+    // 2) Normalizacao de um texto longo agrupado, inclusive no proprio buffer.
+    static char linear[MAX_MESSAGE_LENGTH * 2 + 1];
+    static char grouped[MAX_MESSAGE_LENGTH * 4];
+    long linear_length = MAX_MESSAGE_LENGTH * 2 - 7;
+    for (long i = 0; i < linear_length; i++)
+        linear[i] = "ADFGVX"[(i * 7 + i / 5) % 6];
+    linear[linear_length] = '\0';
+    long grouped_length = adfgvx_format_ciphertext(linear, linear_length, 0, ADFGVX_GROUP_SIZE,
+                                                   ADFGVX_GROUPS_PER_LINE, grouped);
+    grouped[grouped_length++] = '\r';
+    grouped[grouped_length++] = '\n';
+    // Separadores raros em dois blocos: so esses blocos passam pelo laco escalar.
+    grouped[5] = '\v';
+    grouped[5 + 6 * 1000] = '\f';
+
+    long symbol_count, invalid_offset;
+    int status = adfgvx_ingest_ciphertext(grouped, grouped_length, grouped, &symbol_count, &invalid_offset);
+    failures += status != 0 || symbol_count != linear_length || memcmp(grouped, linear, linear_length) != 0;
+
+    // 3) Primeiro caractere invalido, dentro e fora de um bloco de 16.
+    // O terceiro tem um separador raro no primeiro bloco, antes do caractere invalido.
+    const char *invalid_texts[] = {"ADFGV XAQFG", "ADFGV XADFG VXADF GVXAD FGVXA D1FGV",
+                                   "ADFGV\vXADFG VXADF GVXAD FGVXA D1FGV"};
+    const long invalid_expected[] = {8, 31, 31};
+    char scratch[64];
+    for (int t = 0; t < 3; t++)
+    {
+        status = adfgvx_ingest_ciphertext(invalid_texts[t], (long)strlen(invalid_texts[t]), scratch,
+                                          &symbol_count, &invalid_offset);
+        printf("\t\t\"%s\": codigo %d, invalido na posicao %ld\n", invalid_texts[t], status, invalid_offset);
+        failures += status != 2 || invalid_offset != invalid_expected[t];
+    }
+
+    // 4) Ida e volta por arquivo: cifra, grava agrupado, le de volta e decifra.
+    char key[] = "SEMB2025";
+    int key_length = strlen(key);
+    char message[] = "MENSAGEM LONGA O SUFICIENTE PARA OCUPAR VARIAS LINHAS DE GRUPOS DE CINCO SIMBOLOS, 17.";
+    char encoded_symbol_matrix[key_length][MAX_MESSAGE_LENGTH];
+    int symbols_per_column[MAX_KEY_LENGTH] = {0};
+    char encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    char decrypted[MAX_MESSAGE_LENGTH];
+    cipher_adfgvx(key, key_length, message, encoded_symbol_matrix, symbols_per_column);
+
+    status = write_encrypted_data_to_file(DEFAULT_GROUPED_FILE_FOR_TEST, key_length, encoded_symbol_matrix,
+                                          symbols_per_column, ADFGVX_GROUP_SIZE, ADFGVX_GROUPS_PER_LINE);
+    if (status == 0)
+        status = read_ciphertext_file(DEFAULT_GROUPED_FILE_FOR_TEST, encrypted, sizeof(encrypted), &invalid_offset);
+    if (status == 0)
+    {
+        decipher_adfgvx(encrypted, key, key_length, decrypted);
+        failures += strcmp(decrypted, message) != 0;
+    }
+    else
+    {
+        failures++;
+    }
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: Texto agrupado formatado, normalizado e decifrado corretamente!\n");
+    }
+    else
+    {
+        printf("\tERRO: %d falhas na leitura ou escrita de texto cifrado agrupado.\n", failures);
+    }
+}
+
+/**
+ * @brief Verifica a estimativa do comprimento da chave so com o texto cifrado: para varias
+ * chaves, o comprimento verdadeiro deve estar entre os 3 primeiros da lista, tanto numa
+ * mensagem de tamanho maximo quanto num texto de 1 MB.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_key_length_estimate(void)
+{
+    printf("\n-> Teste: Estimativa do Comprimento da Chave\n");
+    static const char *const words[] = {
+        "O", "RELATORIO", "DA", "UNIDADE", "INDICA", "QUE", "AS", "TROPAS", "AVANCARAM", "PELO",
+        "VALE", "NORTE", "DURANTE", "NOITE", "E", "ENCONTRARAM", "RESISTENCIA", "LEVE", "PERTO", "DO",
+        "RIO", "COMANDO", "SOLICITA", "REFORCOS", "ANTES", "AMANHECER", "POSICAO", "CONFIRMADA", "EM", "SETOR",
+    };
+    const char *keys[] = {"UM", "TRI", "CHAVE", "SEGREDO", "SEMB2025"};
+    const long lengths[] = {MAX_MESSAGE_LENGTH - 1, 1000000};
+    int failures = 0;
+
+    long max_length = lengths[1];
+    char *message = malloc(max_length + 16);
+    char *encrypted = malloc(2 * max_length + 1);
+    if (message == NULL || encrypted == NULL)
+    {
+        printf("\tERRO: Memoria insuficiente para o teste.\n");
+        free(message);
+        free(encrypted);
+        return;
+    }
+
+    // Texto com cara de linguagem natural, gerado de forma deterministica.
+    unsigned long seed = 12345;
+    for (long p = 0; p < max_length;)
+    {
+        seed = seed * 1103515245UL + 12345UL;
+        const char *word = words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+        long word_length = (long)strlen(word);
+        memcpy(message + p, word, word_length);
+        p += word_length;
+        message[p++] = ((seed >> 8) % 9 == 0) ? ',' : ' ';
+    }
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+        {
+            int key_length = strlen(keys[k]);
+            const char *messages[1] = {message};
+            long offsets[2];
+            adfgvx_keylen_report report;
+            char saved = message[lengths[l]];
+
+            message[lengths[l]] = '\0';
+            int status = cipher_adfgvx_batch(keys[k], key_length, messages, 1, encrypted, 2 * max_length, offsets);
+            message[lengths[l]] = saved;
+            if (status == 0)
+                status = adfgvx_estimate_key_length(encrypted, offsets[1], 300, ADFGVX_KEYLEN_THREADS, &report);
+            if (status != 0)
+            {
+                printf("\tERRO: Falha ao cifrar ou estimar (codigo %d).\n", status);
+                failures++;
+                continue;
+            }
+
+            int rank = -1;
+            for (int c = 0; c < report.candidate_count && rank < 0; c++)
+            {
+                if (report.candidates[c].key_length == key_length)
+                    rank = c;
+            }
+            printf("\t\t%7ld simbolos, chave de %d: 1o %d, 2o %d, 3o %d (verdadeiro em %d), %.2f ms\n",
+                   offsets[1], key_length, report.candidates[0].key_length, report.candidates[1].key_length,
+                   report.candidates[2].key_length, rank + 1, report.elapsed_seconds * 1000.0);
+            failures += rank < 0 || rank >= 3;
+        }
+    }
+
+    free(message);
+    free(encrypted);
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: O comprimento verdadeiro esta entre os 3 primeiros candidatos em todos os casos!\n");
+    }
+    else
+    {
+        printf("\tERRO: %d casos sem o comprimento verdadeiro entre os 3 primeiros.\n", failures);
+    }
+}
+
+/**
+ * @brief Argumentos de uma thread do teste das areas de trabalho.
+ */
+typedef struct workspace_test_worker
+{
+    const char *key;
+    const char *const *messages;
+    char (*encrypted)[MAX_MESSAGE_LENGTH * 2 + 1];
+    int message_count;
+    int longest;          // Indice da mensagem mais longa (decifrada primeiro).
+    long growths_after_first;
+    long growths_at_end;
+    long peak;
+    int failures;
+} workspace_test_worker;
+
+/**
+ * @brief Thread do teste das areas de trabalho: decifra a mensagem mais longa e depois todas,
+ * repetidamente, usando a area de trabalho da propria thread.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void *workspace_test_thread(void *arg)
+{
+    workspace_test_worker *worker = arg;
+    int key_length = strlen(worker->key);
+    char decrypted[MAX_MESSAGE_LENGTH];
+
+    decipher_adfgvx(worker->encrypted[worker->longest], (char *)worker->key, key_length, decrypted);
+    worker->failures += strcmp(decrypted, worker->messages[worker->longest]) != 0;
+    worker->growths_after_first = adfgvx_thread_workspace()->growths;
+
+    for (int round = 0; round < 500; round++)
+    {
+        int m = round % worker->message_count;
+        decipher_adfgvx(worker->encrypted[m], (char *)worker->key, key_length, decrypted);
+        worker->failures += strcmp(decrypted, worker->messages[m]) != 0;
+    }
+    worker->growths_at_end = adfgvx_thread_workspace()->growths;
+    worker->peak = adfgvx_thread_workspace()->peak;
+    return NULL;
+}
+
+/**
+ * @brief Verifica as areas de trabalho da decifragem: tamanho proporcional a entrada, uso de
+ * um buffer do chamador sem alocacoes e nenhuma alocacao em chamadas repetidas por thread.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_workspace(void)
+{
+    printf("\n-> Teste: Areas de Trabalho da Decifragem\n");
+
+    char key[] = "SEGREDO";
+    int key_length = strlen(key);
+    const char *messages[] = {
+        "OI", "A", "ATAQUE AO AMANHECER.", "STATUS OK, NENHUM ALERTA.",
+        "TESTANDO A CIFRA ADFGVX COM UMA MENSAGEM UM POUCO MAIOR PARA VARIAS LINHAS DA MATRIZ.",
+        "NODE 7 ONLINE"};
+    int message_count = (int)(sizeof(messages) / sizeof(messages[0]));
+    char encrypted[sizeof(messages) / sizeof(messages[0])][MAX_MESSAGE_LENGTH * 2 + 1];
+    int longest = 0;
+    int failures = 0;
+
+    for (int m = 0; m < message_count; m++)
+    {
+        if (cipher_adfgvx_auto(NULL, key, key_length, messages[m], encrypted[m], sizeof(encrypted[m])) != 0)
+        {
+            printf("\tERRO: Falha ao cifrar a mensagem %d.\n", m);
+            return;
+        }
+        if (strlen(messages[m]) > strlen(messages[longest]))
+            longest = m;
+    }
+
+    // Buffer do chamador: o tamanho exato basta e nada e alocado.
+    char buffer[512];
+    char decrypted[MAX_MESSAGE_LENGTH];
+    adfgvx_workspace workspace;
+    adfgvx_workspace_init(&workspace, buffer, sizeof(buffer));
+    for (int m = 0; m < message_count; m++)
+    {
+        long needed = decipher_adfgvx_workspace_size((long)strlen(encrypted[m]), key_length);
+        int status = decipher_adfgvx_with_workspace(&workspace, encrypted[m], key, key_length, decrypted);
+        failures += status != 0 || strcmp(decrypted, messages[m]) != 0;
+        failures += needed > (long)sizeof(buffer) || needed > 4 * (long)strlen(encrypted[m]) + 64;
+    }
+    failures += workspace.growths != 0 || workspace.base != buffer;
+    printf("\t\tBuffer do chamador: pico de %ld de %ld bytes, %ld alocacoes (texto de 2 simbolos: %ld bytes)\n",
+           workspace.peak, (long)sizeof(buffer), workspace.growths,
+           decipher_adfgvx_workspace_size((long)strlen(encrypted[1]), key_length));
+    adfgvx_workspace_release(&workspace);
+
+    // Areas por thread: so a primeira decifragem (a do texto mais longo) aloca memoria.
+    workspace_test_worker workers[4];
+    pthread_t threads[4];
+    int started = 0;
+    for (; started < 4; started++)
+    {
+        workspace_test_worker *worker = &workers[started];
+        worker->key = key;
+        worker->messages = messages;
+        worker->encrypted = encrypted;
+        worker->message_count = message_count;
+        worker->longest = longest;
+        worker->failures = 0;
+        if (pthread_create(&threads[started], NULL, workspace_test_thread, worker) != 0)
+            break;
+    }
+    long expected_peak = decipher_adfgvx_workspace_size((long)strlen(encrypted[longest]), key_length);
+    for (int t = 0; t < started; t++)
+    {
+        pthread_join(threads[t], NULL);
+        failures += workers[t].failures;
+        failures += workers[t].growths_after_first != 1 || workers[t].growths_at_end != 1;
+        failures += workers[t].peak != expected_peak;
+    }
+    failures += started != 4;
+
+    adfgvx_workspace_stats stats;
+    adfgvx_workspace_pool_stats(&stats);
+    printf("\t\tThreads: %d, pico por thread %ld bytes, maior capacidade no pool %ld bytes, %ld alocacoes no total\n",
+           started, expected_peak, stats.peak_capacity, stats.growths);
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: Areas de trabalho dimensionadas pela entrada, sem alocacoes em chamadas repetidas!\n");
+    }
+    else
+    {
+        printf("\tERRO: %d falhas no teste das areas de trabalho.\n", failures);
+    }
+}
+
+/**
+ * @brief Verifica a busca distribuida de chaves: uma execucao interrompida (limite de shards)
+ * e retomada do checkpoint chega aos mesmos resultados de uma execucao sem interrupcao, e o
+ * melhor resultado decifra a mensagem.
+ * (Funcao auxiliar estatica para os testes neste arquivo)
+ */
+static void test_shard_search(void)
+{
+    printf("\n-> Teste: Busca Distribuida de Chaves com Checkpoint\n");
+
+    char key[] = "SEGREDO";
+    int key_length = strlen(key);
+    const char *message = "O RELATORIO DA UNIDADE INDICA QUE AS TROPAS AVANCARAM PELO VALE DURANTE A NOITE, "
+                          "ENCONTRARAM RESISTENCIA LEVE PERTO DO RIO E AGUARDAM REFORCOS ANTES DO AMANHECER. "
+                          "A POSICAO FOI CONFIRMADA PELO COMANDO DO SETOR SUL.";
+    char encrypted[MAX_MESSAGE_LENGTH * 2 + 1];
+    char decrypted[MAX_MESSAGE_LENGTH];
+    int failures = 0;
+
+    if (cipher_adfgvx_auto(NULL, key, key_length, message, encrypted, sizeof(encrypted)) != 0)
+    {
+        printf("\tERRO: Falha ao cifrar a mensagem do teste.\n");
+        return;
+    }
+    remove(DEFAULT_SEARCH_CHECKPOINT_FOR_TEST);
+
+    adfgvx_shard_config config;
+    adfgvx_shard_report interrupted, resumed, uninterrupted;
+    config.ciphertext = encrypted;
+    config.key_length = key_length;
+    config.shard_size = 256;
+    config.worker_count = 3;
+    config.top_n = 8;
+    config.checkpoint_file = DEFAULT_SEARCH_CHECKPOINT_FOR_TEST;
+
+    // Primeira execucao "interrompida" depois de 6 shards; a segunda continua do checkpoint.
+    config.max_shards = 6;
+    int status = adfgvx_shard_search(&config, &interrupted);
+    failures += status != 0 || interrupted.complete || interrupted.shards_done != 6;
+    config.max_shards = 0;
+    status = adfgvx_shard_search(&config, &resumed);
+    failures += status != 0 || !resumed.complete || resumed.shards_resumed != 6;
+    failures += resumed.orderings_evaluated != 5040 - 6 * 256;
+    printf("\t\tShards: %ld; execucao interrompida: %ld; retomada: %ld retomados + %ld ordenacoes em %.3fs\n",
+           resumed.shard_count, interrupted.shards_done, resumed.shards_resumed, resumed.orderings_evaluated,
+           resumed.elapsed_seconds);
+
+    // Checkpoint de outra busca (outro comprimento de chave) e recusado.
+    config.key_length = key_length - 1;
+    failures += adfgvx_shard_search(&config, &uninterrupted) != 2;
+    config.key_length = key_length;
+
+    // Execucao unica, sem checkpoint: mesmos resultados, na mesma ordem.
+    config.checkpoint_file = NULL;
+    status = adfgvx_shard_search(&config, &uninterrupted);
+    failures += status != 0 || !uninterrupted.complete || uninterrupted.orderings_evaluated != 5040;
+    failures += uninterrupted.result_count != resumed.result_count;
+    for (int r = 0; r < resumed.result_count && r < uninterrupted.result_count; r++)
+    {
+        failures += resumed.results[r].ordering != uninterrupted.results[r].ordering;
+        failures += resumed.results[r].score != uninterrupted.results[r].score;
+        failures += strcmp(resumed.results[r].key, uninterrupted.results[r].key) != 0;
+    }
+
+    // Um trabalhador morre (_exit) no meio do seu primeiro shard: o shard volta para a fila,
+    // e os demais chegam aos mesmos resultados.
+    adfgvx_shard_report crashed;
+    adfgvx_shard_test_set_worker_exit(100);
+    status = adfgvx_shard_search(&config, &crashed);
+    adfgvx_shard_test_set_worker_exit(0);
+    failures += status != 0 || !crashed.complete || crashed.worker_failures != 1;
+    failures += crashed.orderings_evaluated != 5040 || crashed.result_count != uninterrupted.result_count;
+    for (int r = 0; r < crashed.result_count && r < uninterrupted.result_count; r++)
+        failures += crashed.results[r].ordering != uninterrupted.results[r].ordering;
+    printf("\t\tTrabalhador encerrado no meio de um shard: %d falha(s), %ld de %ld shards concluidos\n",
+           crashed.worker_failures, crashed.shards_done, crashed.shard_count);
+
+    if (resumed.result_count > 0)
+    {
+        decipher_adfgvx(encrypted, resumed.results[0].key, key_length, decrypted);
+        failures += strcmp(decrypted, message) != 0;
+        printf("\t\tMelhor chave equivalente: \"%s\" (pontuacao %.4f; segunda %.4f)\n", resumed.results[0].key,
+               resumed.results[0].score, resumed.results[1].score);
+    }
+    else
+    {
+        failures++;
+    }
+    remove(DEFAULT_SEARCH_CHECKPOINT_FOR_TEST);
+
+    if (failures == 0)
+    {
+        printf("\tSUCESSO: Busca retomada do checkpoint igual a busca completa, e a melhor chave decifra a mensagem!\n");
+    }
+    else
+    {
+        printf("\tERRO: %d falhas no teste da busca distribuida.\n", failures);
+    }
+}
+
 int main()
 {
     char key_buffer[MAX_KEY_LENGTH];
-    char original_message_for_comparison[MAX_MESSAGE_LENGTH];
-    char encrypted_text_from_file[MAX_MESSAGE_LENGTH * 2 + 1];
-    char decrypted_message_buffer[MAX_MESSAGE_LENGTH];
     int key_len_actual = 0;
     int status;
 
+    // Texto cifrado, mensagem decifrada e mensagem original ficam em uma area de trabalho
+    // dimensionada pelos arquivos lidos (limitada pelos maximos de cipher_config.h).
+    adfgvx_workspace workspace;
+    adfgvx_workspace_init(&workspace, NULL, 0);
+    long encrypted_file_size = get_file_size(DEFAULT_ENCRYPTED_FILE);
+    long message_file_size = get_file_size(DEFAULT_MESSAGE_FILE);
+    int encrypted_capacity = encrypted_file_size >= 0 && encrypted_file_size < MAX_MESSAGE_LENGTH * 2 ? (int)encrypted_file_size + 1 : MAX_MESSAGE_LENGTH * 2 + 1;
+    int decrypted_capacity = encrypted_capacity / 2 + 1 < MAX_MESSAGE_LENGTH ? encrypted_capacity / 2 + 1 : MAX_MESSAGE_LENGTH;
+    int original_capacity = message_file_size >= 0 && message_file_size < MAX_MESSAGE_LENGTH ? (int)message_file_size + 1 : MAX_MESSAGE_LENGTH;
+    char *encrypted_text_from_file = NULL;
+    char *decrypted_message_buffer = NULL;
+    char *original_message_for_comparison = NULL;
+    if (adfgvx_workspace_reserve(&workspace, adfgvx_workspace_region_size(encrypted_capacity) +
+                                                 adfgvx_workspace_region_size(decrypted_capacity) +
+                                                 adfgvx_workspace_region_size(original_capacity)) == 0)
+    {
+        encrypted_text_from_file = adfgvx_workspace_alloc(&workspace, encrypted_capacity);
+        decrypted_message_buffer = adfgvx_workspace_alloc(&workspace, decrypted_capacity);
+        original_message_for_comparison = adfgvx_workspace_alloc(&workspace, original_capacity);
+    }
+    else
+    {
+        fprintf(stderr, "Memoria insuficiente para os buffers da etapa principal.\n");
+    }
+
     printf("--- PROGRAMA DE TESTE DE DECIFRAGEM E OUTROS TESTES ADFGVX ---\n");
 
     // Etapa principal: Decifrar um arquivo e comparar
@@ -185,7 +1406,7 @@ int main()
 
     // 1. Ler chave
     printf("Lendo chave de '%s'...\n", DEFAULT_KEY_FILE);
-    status = read_file(DEFAULT_KEY_FILE, key_buffer, MAX_KEY_LENGTH);
+    status = encrypted_text_from_file != NULL ? read_file(DEFAULT_KEY_FILE, key_buffer, MAX_KEY_LENGTH) : 1;
     if (status != 0) {
         fprintf(stderr, "Erro ao ler o arquivo da chave '%s'. Cdigo: %d. Saindo da etapa principal.\n", DEFAULT_KEY_FILE, status);
         // Prosseguir para os testes auto-contidos
@@ -199,8 +1420,13 @@ int main()
 
             // 2. Ler texto cifrado
             printf("Lendo texto cifrado de '%s'...\n", DEFAULT_ENCRYPTED_FILE);
-            status = read_file(DEFAULT_ENCRYPTED_FILE, encrypted_text_from_file, sizeof(encrypted_text_from_file));
+            // Aceita o texto linear ou agrupado (espacos e quebras de linha sao removidos).
+            long invalid_offset;
+            status = read_ciphertext_file(DEFAULT_ENCRYPTED_FILE, encrypted_text_from_file, encrypted_capacity,
+                                          &invalid_offset);
             if (status != 0) {
+                if (invalid_offset >= 0)
+                    fprintf(stderr, "Caractere invalido na posicao %ld do arquivo cifrado.\n", invalid_offset);
                 fprintf(stderr, "Erro ao ler o arquivo cifrado '%s'. Cdigo: %d.\n", DEFAULT_ENCRYPTED_FILE, status);
                 fprintf(stderr, "Certifique-se de que este arquivo existe (gerado por uma ferramenta de cifragem).\n");
             } else {
@@ -223,7 +1449,7 @@ int main()
 
                 // 5. Comparar com original
                 printf("Lendo mensagem original de '%s' para comparao...\n", DEFAULT_MESSAGE_FILE);
-                status = read_file(DEFAULT_MESSAGE_FILE, original_message_for_comparison, MAX_MESSAGE_LENGTH);
+                status = read_file(DEFAULT_MESSAGE_FILE, original_message_for_comparison, original_capacity);
                 if (status != 0) {
                     fprintf(stderr, "Erro ao ler o arquivo da mensagem original '%s'. Cdigo: %d. Comparao no ser feita.\n", DEFAULT_MESSAGE_FILE, status);
                 } else {
@@ -237,6 +1463,8 @@ int main()
         }
     }
 
+    adfgvx_workspace_release(&workspace);
+
     // --- Executar os "outros testes" (adaptados do monoltico) ---
     printf("\n--- EXECUTANDO TESTES INTERNOS ADICIONAIS ---\n");
 
@@ -249,6 +1477,18 @@ int main()
 
     test_execution_time(); // Usa cipher_adfgvx
     test_invalid_character(); // Usa cipher_adfgvx
+    test_stream_decipher();   // Usa cipher_adfgvx e adfgvx_stream
+    test_batch_cipher();      // Usa cipher_adfgvx e adfgvx_batch
+    test_dispatch();          // Usa adfgvx_dispatch
+    test_column_store();      // Usa adfgvx_column_store e adfgvx_stream
+    test_crib_search();       // Usa adfgvx_crib
+    test_pipeline();          // Usa adfgvx_pipeline e adfgvx_batch
+    test_fractionating_variants(); // Usa fractionating_cipher e cipher_adfgvx
+    test_result_cache();      // Usa adfgvx_cache e adfgvx_dispatch
+    test_grouped_ciphertext(); // Usa adfgvx_format e file_operations
+    test_key_length_estimate(); // Usa adfgvx_keylen e adfgvx_batch
+    test_workspace();         // Usa adfgvx_workspace e adfgvx_decipher
+    test_shard_search();      // Usa adfgvx_shard e adfgvx_decipher
 
     printf("\n--- FIM DO PROGRAMA DE TESTES ---\n");
     return EXIT_SUCCESS;